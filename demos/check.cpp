@@ -0,0 +1,1417 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef ISOTROPIC
+#error check.cpp cannot be linked to isotropic VMMC library!
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+#include "Demo.h"
+#include "VMMC.h"
+
+#ifndef M_PI
+    #define M_PI 3.1415926535897932384626433832795
+#endif
+
+// Checks of the incrementally updated parts of the library against brute-force
+// results. Apart from the ensemble averages, whose tolerances are several times
+// their statistical error, the checks don't depend on the random number stream,
+// i.e. they hold for every trajectory, so a failure always indicates a bug. Run
+// with "make check".
+
+using namespace std::placeholders;
+
+//! Container for a random configuration of particles.
+struct System
+{
+    //! Constructor.
+    /*! \param dimension
+            The dimension of the simulation box.
+
+        \param nParticles
+            The number of particles.
+
+        \param density
+            The particle density.
+
+        \param cutOff
+            The cell list cut-off distance.
+
+        \param nTypes
+            The number of species (particles are assigned to each in turn).
+     */
+    System(unsigned int, unsigned int, double, double, unsigned int nTypes = 1);
+
+    //! Get the total pair energy of the configuration.
+    /*! \param model
+            The model.
+
+        \return
+            The total energy.
+     */
+    double computeEnergy(Model&) const;
+
+    std::vector<double> boxSize;            //!< The size of the simulation box.
+    Box box;                                //!< The simulation box.
+    std::vector<Particle> particles;        //!< The particles.
+    CellList cells;                         //!< The cell list.
+    std::vector<double> coordinates;        //!< The initial coordinates (for VMMC).
+    std::vector<double> orientations;       //!< The initial orientations (for VMMC).
+    std::unique_ptr<bool[]> isIsotropic;    //!< Whether each particle is isotropic (for VMMC).
+};
+
+//! Work out the size of a cubic box.
+static std::vector<double> computeBoxSize(unsigned int dimension, unsigned int nParticles, double density)
+{
+    double baseLength;
+
+    // Particle diameter is one.
+    if (dimension == 2) baseLength = std::pow((nParticles*M_PI)/(4.0*density), 1.0/2.0);
+    else baseLength = std::pow((nParticles*M_PI)/(6.0*density), 1.0/3.0);
+
+    return std::vector<double>(dimension, baseLength);
+}
+
+System::System(unsigned int dimension, unsigned int nParticles, double density, double cutOff, unsigned int nTypes) :
+    boxSize(computeBoxSize(dimension, nParticles, density)),
+    box(boxSize),
+    particles(nParticles),
+    coordinates(dimension*nParticles),
+    orientations(dimension*nParticles),
+    isIsotropic(new bool[nParticles])
+{
+    for (unsigned int i=0;i<nParticles;i++)
+        particles[i].type = i % nTypes;
+
+    cells.setDimension(dimension);
+    cells.initialise(box.boxSize, cutOff);
+
+    // Generate a reproducible random configuration.
+    MersenneTwister rng(42);
+    Initialise initialise;
+    initialise.random(particles, cells, box, rng, false);
+
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        for (unsigned int j=0;j<dimension;j++)
+        {
+            coordinates[dimension*i + j] = particles[i].position[j];
+            orientations[dimension*i + j] = particles[i].orientation[j];
+        }
+
+        isIsotropic[i] = true;
+    }
+}
+
+double System::computeEnergy(Model& model) const
+{
+    // getEnergy returns the mean energy per particle.
+    return model.getEnergy()*particles.size();
+}
+
+//! Bind the pairwise callbacks of a model (by pointer).
+template <typename T>
+static vmmc::CallbackFunctions bindCallbacks(T& model)
+{
+    vmmc::CallbackFunctions callbacks;
+
+    callbacks.energyCallback = std::bind(&T::computeEnergy, &model, _1, _2, _3);
+    callbacks.pairEnergyCallback = std::bind(&T::computePairEnergy, &model, _1, _2, _3, _4, _5, _6);
+    callbacks.interactionsCallback = std::bind(&T::computeInteractions, &model, _1, _2, _3, _4);
+    callbacks.postMoveCallback = std::bind(&T::applyPostMoveUpdates, &model, _1, _2, _3);
+
+    return callbacks;
+}
+
+//! Report the outcome of a check.
+static bool report(const char* name, bool isPassed, const char* details)
+{
+    printf("%-36s %s  (%s)\n", name, isPassed ? "ok    " : "FAILED", details);
+
+    return isPassed;
+}
+
+//! Compare the incremental cluster tracker with a breadth-first search of the interaction graph.
+static bool compareClusters(Model& model, const System& system, const ClusterTracker& tracker, char* details)
+{
+    unsigned int nParticles = system.particles.size();
+    std::vector<unsigned int> interactions(model.getMaxInteractions());
+
+    // Sorted interaction list of each particle.
+    std::vector<std::vector<unsigned int> > bonds(nParticles);
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        unsigned int nInteractions = model.computeInteractions(i,
+            &system.particles[i].position[0], &system.particles[i].orientation[0], &interactions[0]);
+
+        bonds[i].assign(interactions.begin(), interactions.begin() + nInteractions);
+        std::sort(bonds[i].begin(), bonds[i].end());
+
+        if (bonds[i] != tracker.getBonds(i))
+        {
+            sprintf(details, "bond list of particle %u differs", i);
+            return false;
+        }
+    }
+
+    // Label the connected components.
+    std::vector<unsigned int> components(nParticles, nParticles);
+    std::vector<unsigned int> sizes;
+    std::vector<unsigned int> queue;
+
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        if (components[i] != nParticles) continue;
+
+        unsigned int component = sizes.size();
+        components[i] = component;
+        queue.assign(1, i);
+
+        for (unsigned int j=0;j<queue.size();j++)
+        {
+            for (unsigned int k=0;k<bonds[queue[j]].size();k++)
+            {
+                unsigned int neighbour = bonds[queue[j]][k];
+
+                if (components[neighbour] == nParticles)
+                {
+                    components[neighbour] = component;
+                    queue.push_back(neighbour);
+                }
+            }
+        }
+
+        sizes.push_back(queue.size());
+    }
+
+    if (sizes.size() != tracker.getNumClusters())
+    {
+        sprintf(details, "%u clusters, expected %u", tracker.getNumClusters(), (unsigned int) sizes.size());
+        return false;
+    }
+
+    if (*std::max_element(sizes.begin(), sizes.end()) != tracker.getLargestClusterSize())
+    {
+        sprintf(details, "largest cluster size differs");
+        return false;
+    }
+
+    // Each component must have a single, distinct tracker label.
+    std::vector<unsigned int> labels(sizes.size(), nParticles);
+    std::vector<bool> isUsed(nParticles, false);
+
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        unsigned int component = components[i];
+        unsigned int label = tracker.getCluster(i);
+
+        if (labels[component] == nParticles)
+        {
+            if (isUsed[label])
+            {
+                sprintf(details, "cluster label %u is shared by separate clusters", label);
+                return false;
+            }
+
+            labels[component] = label;
+            isUsed[label] = true;
+        }
+        else if (labels[component] != label)
+        {
+            sprintf(details, "cluster containing particle %u has several labels", i);
+            return false;
+        }
+
+        if (tracker.getClusterSize(i) != sizes[component])
+        {
+            sprintf(details, "size of cluster containing particle %u differs", i);
+            return false;
+        }
+    }
+
+    // Cluster size histogram.
+    std::vector<unsigned int> histogram(nParticles + 1, 0);
+    for (unsigned int i=0;i<sizes.size();i++)
+        histogram[sizes[i]]++;
+
+    const std::vector<unsigned int>& trackerHistogram = tracker.getSizeHistogram();
+    for (unsigned int i=0;i<=nParticles;i++)
+    {
+        if (histogram[i] != ((i < trackerHistogram.size()) ? trackerHistogram[i] : 0))
+        {
+            sprintf(details, "histogram differs for clusters of size %u", i);
+            return false;
+        }
+    }
+
+    // Energy of the bond network.
+    double energy = system.computeEnergy(model);
+    if (std::abs(tracker.getEnergy() - energy) > 1e-9*(1 + std::abs(energy)))
+    {
+        sprintf(details, "energy %.10f, expected %.10f", tracker.getEnergy(), energy);
+        return false;
+    }
+
+    return true;
+}
+
+//! Check the cluster tracker against a full recomputation as clusters merge and split.
+static bool checkClusterTracker()
+{
+    unsigned int nParticles = 500;
+    System system(2, nParticles, 0.3, 1.1);
+    SquareWellium model(system.box, system.particles, system.cells, 10, 3.0, 1.1);
+    ClusterTracker tracker(model);
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+    callbacks.observerCallback = std::bind(&ClusterTracker::observe, &tracker, _1, _2, _3);
+
+    vmmc::VMMC vmmc(nParticles, 2, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, 10, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    char details[256];
+    unsigned int nMerges = 0, nSplits = 0;
+    unsigned int nClusters = tracker.getNumClusters();
+
+    for (unsigned int i=0;i<200;i++)
+    {
+        vmmc += nParticles;
+
+        if (!compareClusters(model, system, tracker, details))
+            return report("cluster tracker merge/split", false, details);
+
+        // Count the sweeps over which clusters merged or split (on balance).
+        if (tracker.getNumClusters() < nClusters) nMerges++;
+        if (tracker.getNumClusters() > nClusters) nSplits++;
+        nClusters = tracker.getNumClusters();
+    }
+
+    sprintf(details, "200 sweeps, %u merging and %u splitting", nMerges, nSplits);
+
+    return report("cluster tracker merge/split", (nMerges > 0) && (nSplits > 0), details);
+}
+
+//! Measure the distribution of the number of bonds per particle in a square-well fluid.
+/*! \param isBiased
+        Whether to enable aggregation-volume-bias moves.
+
+    \param boxSize
+        The size of the simulation box.
+
+    \return
+        The fraction of particles with each number of bonds.
+ */
+static std::vector<double> computeBondOccupancy(bool isBiased, std::vector<double>& boxSize)
+{
+    unsigned int nParticles = 2;
+    System system(3, nParticles, 0.02, 1.1);
+    SquareWellium model(system.box, system.particles, system.cells, 15, 2.0, 1.1);
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+
+    // Large trial moves decorrelate the pair quickly.
+    vmmc::VMMC vmmc(nParticles, 3, &system.coordinates[0], &system.orientations[0],
+        0.5, 0.2, 0.5, 0.5, 15, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    if (isBiased) vmmc.setAggregationVolumeBias(0.2, 1.0, 1.1);
+
+    // Equilibrate.
+    vmmc += 1000*nParticles;
+
+    std::vector<double> occupancy(nParticles);
+    std::vector<unsigned int> interactions(model.getMaxInteractions());
+    unsigned int nSamples = 50000;
+
+    for (unsigned int i=0;i<nSamples;i++)
+    {
+        vmmc += 10*nParticles;
+
+        for (unsigned int j=0;j<nParticles;j++)
+            occupancy[model.computeInteractions(j, &system.particles[j].position[0],
+                &system.particles[j].orientation[0], &interactions[0])]++;
+    }
+
+    for (unsigned int i=0;i<nParticles;i++)
+        occupancy[i] /= nSamples*nParticles;
+
+    boxSize = system.boxSize;
+
+    return occupancy;
+}
+
+//! Check that aggregation-volume-bias moves leave the bond occupancy distribution unchanged.
+static bool checkAggregationVolumeBias()
+{
+    std::vector<double> boxSize;
+    std::vector<double> plain = computeBondOccupancy(false, boxSize);
+    std::vector<double> biased = computeBondOccupancy(true, boxSize);
+
+    // A pair of particles is bonded with probability proportional to the
+    // Boltzmann weighted volume of the well.
+    double volume = boxSize[0]*boxSize[1]*boxSize[2];
+    double core = 4.0*M_PI/3.0;
+    double well = core*(1.1*1.1*1.1 - 1);
+    double bonded = std::exp(2.0)*well/(std::exp(2.0)*well + volume - core - well);
+
+    bool isPassed = (std::abs(plain[1] - bonded) < 0.02) && (std::abs(biased[1] - bonded) < 0.02);
+
+    char details[256];
+    sprintf(details, "bonded fraction %.3f, %.3f with AVB (%.3f)", plain[1], biased[1], bonded);
+
+    return report("AVB bond occupancy", isPassed, details);
+}
+
+//! Run swap moves in a mixture with a bias that cancels the brute-force energy change.
+/*! \param margin
+        An offset added to the bias, i.e. the expected (negative) log acceptance.
+
+    \param nBiased
+        The number of swaps that reached the acceptance test.
+
+    \param nChanged
+        The number of those swaps that changed the energy.
+
+    \return
+        The number of accepted swaps.
+ */
+static unsigned int runSwapMoves(double margin, unsigned int& nBiased, unsigned int& nChanged)
+{
+    unsigned int nParticles = 200;
+    System system(2, nParticles, 0.3, 1.1, 2);
+
+    // Only unlike particles attract. The well is deep, so that any error in
+    // the energy change is far larger than the margin.
+    InteractionTable table(2);
+    table.set(0, 1, 50.0, 1.1);
+    SquareWelliumMixture model(system.box, system.particles, system.cells, table, 10);
+
+    std::vector<unsigned int> species(nParticles);
+    for (unsigned int i=0;i<nParticles;i++) species[i] = system.particles[i].type;
+
+    double energy = system.computeEnergy(model);
+    unsigned int nAccepted = 0;
+    nBiased = nChanged = 0;
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+
+    // The bias is called once the swap has been applied, so it can measure the energy change.
+    callbacks.biasCallback = [&](unsigned int, const unsigned int*)
+    {
+        double change = system.computeEnergy(model) - energy;
+
+        nBiased++;
+        if (change != 0) nChanged++;
+
+        return margin - change;
+    };
+
+    callbacks.observerCallback = [&](unsigned int nMoving, const unsigned int*, bool isAccepted)
+    {
+        if ((nMoving > 0) && isAccepted)
+        {
+            nAccepted++;
+            energy = system.computeEnergy(model);
+        }
+    };
+
+    vmmc::VMMC vmmc(nParticles, 2, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, 10, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    // Every trial move is a swap.
+    vmmc.setSwapMoves(1.0, &species[0]);
+    vmmc += 20000;
+
+    return nAccepted;
+}
+
+//! Check the swap move energy change against the brute-force change in the total energy.
+static bool checkSwapMoves()
+{
+    char details[256];
+    unsigned int nBiased, nChanged;
+
+    // If the engine's energy change matches, the net energy change is zero, so
+    // every swap is accepted. An overestimate would cause rejections.
+    unsigned int nAccepted = runSwapMoves(0, nBiased, nChanged);
+    if ((nAccepted != nBiased) || (nChanged == 0))
+    {
+        sprintf(details, "%u of %u swaps accepted, %u changed the energy", nAccepted, nBiased, nChanged);
+        return report("swap move energy change", false, details);
+    }
+
+    // With a margin of 20 kBT almost no swaps are accepted, unless the engine underestimates the change.
+    unsigned int nMargin = runSwapMoves(20, nBiased, nChanged);
+
+    sprintf(details, "%u of %u swaps accepted with zero net change, %u of %u with a 20 kBT margin",
+        nAccepted, nAccepted, nMargin, nBiased);
+
+    return report("swap move energy change", nMargin == 0, details);
+}
+
+//! Run volume moves for square-well particles with a bias that cancels the brute-force log acceptance.
+/*! \param margin
+        An offset added to the bias, i.e. the expected (negative) log acceptance.
+
+    \param nBiased
+        The number of moves that reached the acceptance test.
+
+    \return
+        The number of accepted moves.
+ */
+static unsigned int runVolumeMoves(double margin, unsigned int& nBiased)
+{
+    unsigned int nParticles = 100;
+    double pressure = 0.5;
+    System system(3, nParticles, 0.1, 1.1);
+    SquareWellium model(system.box, system.particles, system.cells, 15, 50.0, 1.1);
+
+    double energy = system.computeEnergy(model);
+    double volume = system.boxSize[0]*system.boxSize[1]*system.boxSize[2];
+    unsigned int nAccepted = 0;
+    nBiased = 0;
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+    callbacks.boxCallback = std::bind(&SquareWellium::setBoxSize, &model, _1);
+
+    // The bias is called once the box and particles have been rescaled.
+    callbacks.biasCallback = [&](unsigned int, const unsigned int*)
+    {
+        nBiased++;
+
+        double newVolume = system.box.boxSize[0]*system.box.boxSize[1]*system.box.boxSize[2];
+
+        // The log acceptance of a random walk in the logarithm of the volume.
+        return -(system.computeEnergy(model) - energy) - pressure*(newVolume - volume)
+            + (nParticles + 1)*std::log(newVolume/volume) + margin;
+    };
+
+    callbacks.observerCallback = [&](unsigned int nMoving, const unsigned int*, bool isAccepted)
+    {
+        if ((nMoving > 0) && isAccepted)
+        {
+            nAccepted++;
+            energy = system.computeEnergy(model);
+            volume = system.box.boxSize[0]*system.box.boxSize[1]*system.box.boxSize[2];
+        }
+    };
+
+    vmmc::VMMC vmmc(nParticles, 3, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, 15, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    // Every trial move is a volume move (the bias is also applied to cluster moves).
+    vmmc.setVolumeMoves(1.0, pressure, 0.05);
+    vmmc += 4000;
+
+    return nAccepted;
+}
+
+//! Measure the mean volume of an ideal gas under volume moves.
+/*! \param isPerAxis
+        Whether to scale a single axis at a time.
+
+    \return
+        The mean volume.
+ */
+static double computeIdealGasVolume(bool isPerAxis)
+{
+    unsigned int nParticles = 10;
+    double pressure = 1.0;
+
+    std::vector<double> boxSize(3, 3.0);
+    std::vector<double> coordinates(3*nParticles, 1.0);
+    std::vector<double> orientations(3*nParticles, 0);
+    std::unique_ptr<bool[]> isIsotropic(new bool[nParticles]);
+
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        orientations[3*i] = 1.0;
+        isIsotropic[i] = true;
+    }
+
+    // Non-interacting particles.
+    vmmc::CallbackFunctions callbacks;
+    callbacks.energyCallback = [](unsigned int, const double*, const double*) { return 0.0; };
+    callbacks.pairEnergyCallback = [](unsigned int, const double*, const double*,
+        unsigned int, const double*, const double*) { return 0.0; };
+    callbacks.interactionsCallback = [](unsigned int, const double*, const double*, unsigned int*) { return 0u; };
+    callbacks.postMoveCallback = [](unsigned int, const double*, const double*) {};
+    callbacks.boxCallback = [](const double*) { return true; };
+
+    vmmc::VMMC vmmc(nParticles, 3, &coordinates[0], &orientations[0],
+        0.15, 0.2, 0.5, 0.5, 1, &boxSize[0], isIsotropic.get(), false, callbacks);
+
+    vmmc.setVolumeMoves(1.0, pressure, 0.3, isPerAxis);
+
+    // Equilibrate, then average.
+    vmmc += 10000;
+
+    double sum = 0;
+    unsigned int nSamples = 200000;
+
+    for (unsigned int i=0;i<nSamples;i++)
+    {
+        vmmc++;
+
+        const std::vector<double>& size = vmmc.getBoxSize();
+        sum += size[0]*size[1]*size[2];
+    }
+
+    return sum/nSamples;
+}
+
+//! Check the volume move acceptance, both against a brute-force calculation and the ideal gas law.
+static bool checkVolumeMoves()
+{
+    char details[256];
+    unsigned int nBiased;
+
+    // If the engine's log acceptance matches, every move that doesn't cause an overlap is accepted.
+    unsigned int nAccepted = runVolumeMoves(0, nBiased);
+    if (nAccepted != nBiased)
+    {
+        sprintf(details, "%u of %u moves accepted with zero net acceptance", nAccepted, nBiased);
+        return report("volume move acceptance", false, details);
+    }
+
+    unsigned int nMargin = runVolumeMoves(20, nBiased);
+    if (nMargin != 0)
+    {
+        sprintf(details, "%u of %u moves accepted with a 20 kBT margin", nMargin, nBiased);
+        return report("volume move acceptance", false, details);
+    }
+
+    // The isobaric ideal gas has <V> = (N + 1)/P.
+    double isotropic = computeIdealGasVolume(false);
+    double perAxis = computeIdealGasVolume(true);
+    bool isPassed = (std::abs(isotropic/11.0 - 1) < 0.02) && (std::abs(perAxis/11.0 - 1) < 0.02);
+
+    sprintf(details, "%u of %u accepted with zero net acceptance, ideal gas <V> = %.3f, %.3f (11)",
+        nAccepted, nAccepted, isotropic, perAxis);
+
+    return report("volume move acceptance", isPassed, details);
+}
+
+//! A brute-force pair energy: returns the energy and sets whether the pair interacts.
+typedef std::function<double(unsigned int, unsigned int, bool&)> BruteForcePair;
+
+//! Compare the energy and interactions of every particle with a brute-force sum over all pairs.
+/*! \param model
+        The model.
+
+    \param particles
+        The particles.
+
+    \param bruteForce
+        The pair energy and interaction of two particles, worked out from scratch.
+
+    \param details
+        A description of the first discrepancy.
+
+    \return
+        Whether every particle agrees.
+ */
+static bool compareBruteForce(Model& model, const std::vector<Particle>& particles,
+    const BruteForcePair& bruteForce, char* details)
+{
+    std::vector<unsigned int> interactions(model.getMaxInteractions());
+    std::vector<unsigned int> expected;
+
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        double energy = 0;
+        expected.clear();
+
+        for (unsigned int j=0;j<particles.size();j++)
+        {
+            if (j == i) continue;
+
+            bool isInteracting = false;
+            energy += bruteForce(i, j, isInteracting);
+            if (isInteracting) expected.push_back(j);
+        }
+
+        double modelEnergy = model.computeEnergy(i, &particles[i].position[0], &particles[i].orientation[0]);
+
+        // Hard core overlaps are infinite.
+        bool isMatch = std::isinf(energy) ? std::isinf(modelEnergy)
+            : (std::abs(modelEnergy - energy) <= 1e-9*(1 + std::abs(energy)));
+
+        if (!isMatch)
+        {
+            sprintf(details, "energy of particle %u is %.10f, expected %.10f", i, modelEnergy, energy);
+            return false;
+        }
+
+        unsigned int nInteractions = model.computeInteractions(i,
+            &particles[i].position[0], &particles[i].orientation[0], &interactions[0]);
+
+        std::vector<unsigned int> found(interactions.begin(), interactions.begin() + nInteractions);
+        std::sort(found.begin(), found.end());
+
+        if (found != expected)
+        {
+            sprintf(details, "particle %u has %u interactions, expected %u",
+                i, nInteractions, (unsigned int) expected.size());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Work out the squared minimum image separation of two particles from scratch.
+static double computeSeparation(const std::vector<Particle>& particles, unsigned int particle1,
+    unsigned int particle2, const std::vector<double>& boxSize, double* sep = nullptr)
+{
+    double normSqd = 0;
+
+    for (unsigned int k=0;k<boxSize.size();k++)
+    {
+        double x = particles[particle2].position[k] - particles[particle1].position[k];
+        x -= boxSize[k]*std::round(x/boxSize[k]);
+        normSqd += x*x;
+
+        if (sep) sep[k] = x;
+    }
+
+    return normSqd;
+}
+
+//! Check the multi-level cell list of a polydisperse fluid against a brute-force search.
+static bool checkPolydisperseCells()
+{
+    unsigned int nParticles = 500;
+    double interactionEnergy = 1.5;
+    double interactionRange = 1.1;
+
+    std::vector<Particle> particles(nParticles);
+    MersenneTwister rng(42);
+
+    // A few large and intermediate particles in a polydisperse fluid, so
+    // that there are three size classes.
+    double volume = 0;
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        if (i < 4) particles[i].radius = 2.5;
+        else if (i < 34) particles[i].radius = 1.2;
+        else particles[i].radius = 0.5*(1.0 + 0.1*(2*rng() - 1));
+
+        volume += (4.0/3.0)*M_PI*std::pow(particles[i].radius, 3);
+    }
+
+    std::vector<double> boxSize(3, std::pow(volume/0.1, 1.0/3.0));
+    Box box(boxSize);
+
+    MultiCellList multiCells;
+    multiCells.setDimension(3);
+    multiCells.initialise(box.boxSize, particles, interactionRange);
+
+    PolydisperseSquareWellium model(box, particles, multiCells, 100, interactionEnergy, interactionRange);
+
+    Initialise initialise;
+    initialise.random(particles, multiCells, box, rng);
+
+    std::vector<double> coordinates(3*nParticles);
+    std::vector<double> orientations(3*nParticles);
+    std::unique_ptr<bool[]> isIsotropic(new bool[nParticles]);
+
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        for (unsigned int j=0;j<3;j++)
+        {
+            coordinates[3*i + j] = particles[i].position[j];
+            orientations[3*i + j] = particles[i].orientation[j];
+        }
+
+        isIsotropic[i] = true;
+    }
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+
+    vmmc::VMMC vmmc(nParticles, 3, &coordinates[0], &orientations[0],
+        0.15, 0.2, 0.5, 0.5, 100, &boxSize[0], isIsotropic.get(), false, callbacks);
+
+    // Swap moves exchange particles of different size classes.
+    vmmc.setSwapMoves(0.1);
+
+    // The contact distance depends on the radii of both particles.
+    BruteForcePair bruteForce = [&](unsigned int i, unsigned int j, bool& isInteracting)
+    {
+        double sigma = particles[i].radius + particles[j].radius;
+        double normSqd = computeSeparation(particles, i, j, boxSize);
+
+        isInteracting = (normSqd < interactionRange*interactionRange*sigma*sigma);
+        if (normSqd < sigma*sigma) return INF;
+        return isInteracting ? -interactionEnergy : 0.0;
+    };
+
+    char details[256];
+
+    for (unsigned int i=0;i<20;i++)
+    {
+        vmmc += 10*nParticles;
+
+        if (!compareBruteForce(model, particles, bruteForce, details))
+            return report("polydisperse cell lists", false, details);
+    }
+
+    sprintf(details, "%u size classes, %llu of %llu swaps accepted", (unsigned int) multiCells.size(),
+        vmmc.getSwapAccepts(), vmmc.getSwapAttempts());
+
+    return report("polydisperse cell lists", vmmc.getSwapAccepts() > 0, details);
+}
+
+//! Check a mixture with a distinct interaction for every pair of species against a brute-force sum.
+static bool checkMixtureTable()
+{
+    unsigned int nTypes = 3;
+    unsigned int nParticles = 300;
+
+    // Well depth, range, and contact distance of each pair of species.
+    double parameters[3][3][3] = {
+        {{0.5, 1.3, 1.0}, {1.0, 1.2, 0.9}, {1.5, 1.5, 0.8}},
+        {{1.0, 1.2, 0.9}, {0.0, 1.0, 1.0}, {2.0, 1.1, 1.0}},
+        {{1.5, 1.5, 0.8}, {2.0, 1.1, 1.0}, {0.8, 1.4, 0.85}}
+    };
+
+    InteractionTable table(nTypes);
+    for (unsigned int i=0;i<nTypes;i++)
+        for (unsigned int j=i;j<nTypes;j++)
+            table.set(i, j, parameters[i][j][0], parameters[i][j][1], parameters[i][j][2]);
+
+    System system(3, nParticles, 0.2, table.getMaxCutOff(), nTypes);
+    SquareWelliumMixture model(system.box, system.particles, system.cells, table, 30);
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+
+    vmmc::VMMC vmmc(nParticles, 3, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, 30, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    BruteForcePair bruteForce = [&](unsigned int i, unsigned int j, bool& isInteracting)
+    {
+        const double* pair = parameters[system.particles[i].type][system.particles[j].type];
+        double normSqd = computeSeparation(system.particles, i, j, system.boxSize);
+
+        isInteracting = (normSqd < pair[1]*pair[1]*pair[2]*pair[2]);
+        if (normSqd < pair[2]*pair[2]) return INF;
+        return isInteracting ? -pair[0] : 0.0;
+    };
+
+    char details[256];
+
+    for (unsigned int i=0;i<20;i++)
+    {
+        vmmc += 10*nParticles;
+
+        if (!compareBruteForce(model, system.particles, bruteForce, details))
+            return report("mixture interaction table", false, details);
+    }
+
+    sprintf(details, "%u species, energy per particle %.3f", nTypes, model.getEnergy());
+
+    return report("mixture interaction table", true, details);
+}
+
+//! Check that the patch vectors of patchy spheres stay orthonormal and turn rigidly with cluster moves.
+static bool checkPatchySpheres()
+{
+    unsigned int nParticles = 300;
+    unsigned int nPatches = 4;
+
+    // Four patches arranged tetrahedrally in the body frame.
+    std::vector<std::vector<double> > patchDirections(nPatches, std::vector<double>(3));
+    double tetrahedron[4][3] = {{1, 1, 1}, {1, -1, -1}, {-1, 1, -1}, {-1, -1, 1}};
+    for (unsigned int i=0;i<nPatches;i++)
+        for (unsigned int j=0;j<3;j++)
+            patchDirections[i][j] = tetrahedron[i][j]/std::sqrt(3.0);
+
+    System system(3, nParticles, 0.1, 1.12);
+    PatchySphere model(system.box, system.particles, system.cells, nPatches, 7.0, 1.12, patchDirections, 0.4);
+    model.initialisePatches();
+
+    for (unsigned int i=0;i<nParticles;i++)
+        system.isIsotropic[i] = false;
+
+    // Get a patch vector of a particle.
+    auto getPatch = [&](unsigned int particle, unsigned int patch, double* vec)
+    {
+        const double* patches = model.getPatches(particle);
+        for (unsigned int k=0;k<3;k++) vec[k] = patches[k*nPatches + patch];
+    };
+
+    // The positions and patch vectors of each particle following its last move.
+    std::vector<double> positions(system.coordinates);
+    std::vector<double> patches(3*nPatches*nParticles);
+    for (unsigned int i=0;i<nParticles;i++)
+        for (unsigned int j=0;j<nPatches;j++)
+            getPatch(i, j, &patches[3*(nPatches*i + j)]);
+
+    // Work out the separation of two particles and the dot products of
+    // their patch vectors with each other and the separation.
+    auto computeInvariants = [&](const double* position1, const double* patches1,
+        const double* position2, const double* patches2, std::vector<double>& invariants)
+    {
+        double sep[3];
+        for (unsigned int k=0;k<3;k++)
+        {
+            sep[k] = position2[k] - position1[k];
+            sep[k] -= system.boxSize[k]*std::round(sep[k]/system.boxSize[k]);
+        }
+
+        invariants.assign(1, sep[0]*sep[0] + sep[1]*sep[1] + sep[2]*sep[2]);
+
+        for (unsigned int i=0;i<nPatches;i++)
+        {
+            const double* patch1 = &patches1[3*i];
+            invariants.push_back(patch1[0]*sep[0] + patch1[1]*sep[1] + patch1[2]*sep[2]);
+
+            for (unsigned int j=0;j<nPatches;j++)
+            {
+                const double* patch2 = &patches2[3*j];
+                invariants.push_back(patch1[0]*patch2[0] + patch1[1]*patch2[1] + patch1[2]*patch2[2]);
+            }
+        }
+    };
+
+    char details[256];
+    bool isRigid = true;
+    unsigned int nRotations = 0;
+    std::vector<double> before, after, current(3*nPatches*nParticles);
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+
+    // Compare every pair within an accepted cluster before and after the move.
+    callbacks.observerCallback = [&](unsigned int nMoving, const unsigned int* moveList, bool isAccepted)
+    {
+        if (!isAccepted) return;
+
+        for (unsigned int i=0;i<nMoving;i++)
+            for (unsigned int j=0;j<nPatches;j++)
+                getPatch(moveList[i], j, &current[3*(nPatches*moveList[i] + j)]);
+
+        if ((nMoving > 1) && (current[3*nPatches*moveList[0]] != patches[3*nPatches*moveList[0]]))
+            nRotations++;
+
+        for (unsigned int i=0;i<nMoving && isRigid;i++)
+        {
+            for (unsigned int j=i+1;j<nMoving;j++)
+            {
+                unsigned int particle1 = moveList[i], particle2 = moveList[j];
+
+                computeInvariants(&positions[3*particle1], &patches[3*nPatches*particle1],
+                    &positions[3*particle2], &patches[3*nPatches*particle2], before);
+                computeInvariants(&system.particles[particle1].position[0], &current[3*nPatches*particle1],
+                    &system.particles[particle2].position[0], &current[3*nPatches*particle2], after);
+
+                // Skip pairs whose minimum image may change.
+                if (before[0] > 0.0625*system.boxSize[0]*system.boxSize[0]) continue;
+
+                for (unsigned int k=0;k<before.size();k++)
+                {
+                    if (std::abs(after[k] - before[k]) > 1e-9)
+                    {
+                        sprintf(details, "patches of particles %u and %u in a cluster of %u didn't move rigidly",
+                            particle1, particle2, nMoving);
+                        isRigid = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        for (unsigned int i=0;i<nMoving;i++)
+        {
+            unsigned int particle = moveList[i];
+
+            for (unsigned int j=0;j<3;j++)
+                positions[3*particle + j] = system.particles[particle].position[j];
+
+            std::copy(&current[3*nPatches*particle], &current[3*nPatches*(particle + 1)], &patches[3*nPatches*particle]);
+        }
+    };
+
+    vmmc::VMMC vmmc(nParticles, 3, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, nPatches, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    model.setEngine(vmmc);
+
+    for (unsigned int i=0;i<100;i++)
+    {
+        vmmc += 10*nParticles;
+
+        if (!isRigid) return report("patchy sphere frames", false, details);
+
+        // The patch vectors must keep the geometry of the body frame.
+        for (unsigned int j=0;j<nParticles;j++)
+        {
+            double patch1[3], patch2[3];
+
+            for (unsigned int k=0;k<nPatches;k++)
+            {
+                getPatch(j, k, patch1);
+
+                for (unsigned int l=0;l<nPatches;l++)
+                {
+                    getPatch(j, l, patch2);
+
+                    double dot = patch1[0]*patch2[0] + patch1[1]*patch2[1] + patch1[2]*patch2[2];
+                    double expected = (k == l) ? 1.0 : -1.0/3.0;
+
+                    if (std::abs(dot - expected) > 1e-9)
+                    {
+                        sprintf(details, "patches %u and %u of particle %u have dot product %.12f",
+                            k, l, j, dot);
+                        return report("patchy sphere frames", false, details);
+                    }
+                }
+            }
+
+            // A reflection would preserve the dot products but not the handedness.
+            double patch3[3];
+            getPatch(j, 0, patch1);
+            getPatch(j, 1, patch2);
+            getPatch(j, 2, patch3);
+
+            double triple = patch1[0]*(patch2[1]*patch3[2] - patch2[2]*patch3[1])
+                          + patch1[1]*(patch2[2]*patch3[0] - patch2[0]*patch3[2])
+                          + patch1[2]*(patch2[0]*patch3[1] - patch2[1]*patch3[0]);
+
+            // The triple product of the first three tetrahedral directions.
+            if (std::abs(triple - 4.0/std::pow(3.0, 1.5)) > 1e-9)
+            {
+                sprintf(details, "patches of particle %u have changed handedness", j);
+                return report("patchy sphere frames", false, details);
+            }
+        }
+    }
+
+    sprintf(details, "%u accepted cluster rotations, energy per particle %.3f", nRotations, model.getEnergy());
+
+    return report("patchy sphere frames", nRotations > 0, details);
+}
+
+//! Work out the closest approach of two rod axes by minimising over the first axis.
+/*! \param sep
+        The separation of the rod centres.
+
+    \param orientation1
+        The axis direction of the first rod.
+
+    \param orientation2
+        The axis direction of the second rod.
+
+    \param length
+        The length of the rod axes.
+
+    \return
+        The shortest distance between the axes.
+ */
+static double computeAxisDistance(const double* sep, const double* orientation1,
+    const double* orientation2, double length)
+{
+    // Distance from a point on the first axis to the second axis.
+    auto computeDistance = [&](double s)
+    {
+        double vec[3];
+        for (unsigned int k=0;k<3;k++) vec[k] = s*orientation1[k] - sep[k];
+
+        double t = vec[0]*orientation2[0] + vec[1]*orientation2[1] + vec[2]*orientation2[2];
+        t = std::max(-0.5*length, std::min(0.5*length, t));
+
+        double normSqd = 0;
+        for (unsigned int k=0;k<3;k++)
+        {
+            double x = vec[k] - t*orientation2[k];
+            normSqd += x*x;
+        }
+
+        return std::sqrt(normSqd);
+    };
+
+    // The distance is convex along the first axis, so a ternary search converges.
+    double lower = -0.5*length, upper = 0.5*length;
+    for (unsigned int i=0;i<200;i++)
+    {
+        double s1 = lower + (upper - lower)/3;
+        double s2 = upper - (upper - lower)/3;
+
+        if (computeDistance(s1) < computeDistance(s2)) upper = s2;
+        else lower = s1;
+    }
+
+    return computeDistance(0.5*(lower + upper));
+}
+
+//! Check rod energies and interactions on random configurations against a brute-force search.
+static bool checkRods()
+{
+    unsigned int nParticles = 300;
+    double interactionEnergy = 1.5;
+    double interactionRange = 1.3;
+    double length = 3.0;
+
+    System system(3, nParticles, 0.01, length + interactionRange);
+    SquareWelliumRod model(system.box, system.particles, system.cells, 100,
+        interactionEnergy, interactionRange, length);
+
+    MersenneTwister rng(42);
+    std::vector<Particle>& particles = system.particles;
+
+    BruteForcePair bruteForce = [&](unsigned int i, unsigned int j, bool& isInteracting)
+    {
+        double sep[3];
+        computeSeparation(particles, i, j, system.boxSize, sep);
+        double distance = computeAxisDistance(sep, &particles[i].orientation[0], &particles[j].orientation[0], length);
+
+        isInteracting = (distance < interactionRange);
+        if (distance < 1) return INF;
+        return isInteracting ? -interactionEnergy : 0.0;
+    };
+
+    char details[256];
+    unsigned int nPairs = 0;
+
+    // Random orientations, then orientations within a cone of decreasing
+    // width about the z axis, down to exactly parallel rods.
+    for (unsigned int i=0;i<10;i++)
+    {
+        double width = (i == 0) ? 2.0 : ((i == 9) ? 0 : std::pow(10.0, -(double) i));
+
+        for (unsigned int j=0;j<nParticles;j++)
+        {
+            double norm = 0;
+            std::vector<double>& orientation = particles[j].orientation;
+
+            for (unsigned int k=0;k<3;k++)
+            {
+                orientation[k] = width*rng.normal() + ((k == 2) && (i > 0));
+                norm += orientation[k]*orientation[k];
+            }
+
+            for (unsigned int k=0;k<3;k++)
+                orientation[k] /= std::sqrt(norm);
+        }
+
+        if (!compareBruteForce(model, particles, bruteForce, details))
+            return report("rod energies", false, details);
+
+        // Compare the pair energy, which has its own bounding tests.
+        for (unsigned int j=0;j<nParticles;j++)
+        {
+            for (unsigned int k=j+1;k<nParticles;k++)
+            {
+                bool isInteracting;
+                double energy = bruteForce(j, k, isInteracting);
+                double pairEnergy = model.computePairEnergy(j, &particles[j].position[0], &particles[j].orientation[0],
+                    k, &particles[k].position[0], &particles[k].orientation[0]);
+
+                if ((energy != pairEnergy) && !(std::isinf(energy) && std::isinf(pairEnergy)))
+                {
+                    sprintf(details, "pair energy of particles %u and %u is %.3f, expected %.3f",
+                        j, k, pairEnergy, energy);
+                    return report("rod energies", false, details);
+                }
+
+                nPairs += isInteracting;
+            }
+        }
+    }
+
+    sprintf(details, "10 configurations, %u interacting pairs", nPairs);
+
+    return report("rod energies", true, details);
+}
+
+//! Check the cached coordination numbers and many-body energy against a full recomputation after every move.
+static bool checkCoordinationCache()
+{
+    unsigned int nParticles = 150;
+    double interactionRange = 1.1;
+    double coordinationEnergy = 0.5;
+    unsigned int valence = 2;
+
+    System system(3, nParticles, 0.25, interactionRange);
+    CoordinationWellium model(system.box, system.particles, system.cells, 15,
+        2.0, interactionRange, coordinationEnergy, valence);
+    model.initialiseCoordinations();
+
+    char details[256];
+    bool isPassed = true;
+    unsigned int nAccepted = 0, nRejected = 0, nChanged = 0;
+    double previousEnergy = 0;
+    std::vector<unsigned int> coordinations(nParticles);
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+    callbacks.manyBodyCallback = std::bind(&CoordinationWellium::computeManyBodyEnergy, &model, _1, _2);
+
+    // Compare the cache with a brute-force count once the outcome of each move is known.
+    callbacks.observerCallback = [&](unsigned int nMoving, const unsigned int* moveList, bool isAccepted)
+    {
+        model.observe(nMoving, moveList, isAccepted);
+
+        if (!isPassed) return;
+
+        if (isAccepted) nAccepted++;
+        else nRejected++;
+
+        std::fill(coordinations.begin(), coordinations.end(), 0);
+
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            for (unsigned int j=i+1;j<nParticles;j++)
+            {
+                if (computeSeparation(system.particles, i, j, system.boxSize) < interactionRange*interactionRange)
+                {
+                    coordinations[i]++;
+                    coordinations[j]++;
+                }
+            }
+        }
+
+        double energy = 0;
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            if (model.getCoordination(i) != coordinations[i])
+            {
+                sprintf(details, "particle %u has cached coordination %u, expected %u after %s move",
+                    i, model.getCoordination(i), coordinations[i], isAccepted ? "an accepted" : "a rejected");
+                isPassed = false;
+                return;
+            }
+
+            if (coordinations[i] > valence)
+                energy += coordinationEnergy*(coordinations[i] - valence)*(coordinations[i] - valence);
+        }
+
+        // Count the moves that changed the many-body energy.
+        nChanged += (energy != previousEnergy);
+        previousEnergy = energy;
+
+        if (std::abs(model.getManyBodyEnergy()*nParticles - energy) > 1e-9*(1 + energy))
+        {
+            sprintf(details, "cached many-body energy %.10f, expected %.10f after %s move",
+                model.getManyBodyEnergy()*nParticles, energy, isAccepted ? "an accepted" : "a rejected");
+            isPassed = false;
+        }
+    };
+
+    vmmc::VMMC vmmc(nParticles, 3, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, 15, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    vmmc += 20*nParticles;
+
+    if (isPassed)
+        sprintf(details, "%u accepted and %u rejected moves, %u changed the penalty", nAccepted, nRejected, nChanged);
+
+    return report("coordination cache", isPassed && (nAccepted > 0) && (nRejected > 0) && (nChanged > 0), details);
+}
+
+//! Run a square-well mixture with a given energy quantum.
+/*! \param quantum
+        The energy quantum (zero for continuous energies).
+
+    \param particles
+        The final configuration.
+
+    \return
+        The number of accepted moves.
+ */
+static unsigned long long runDiscreteEnergies(double quantum, std::vector<Particle>& particles)
+{
+    unsigned int nParticles = 200;
+
+    // Like pairs have wells of two quanta, unlike pairs a well that isn't a multiple.
+    InteractionTable table(2);
+    table.set(0, 0, 2.0, 1.1);
+    table.set(1, 1, 2.0, 1.1);
+    table.set(0, 1, 0.7, 1.2);
+
+    System system(3, nParticles, 0.2, table.getMaxCutOff(), 2);
+    SquareWelliumMixture model(system.box, system.particles, system.cells, table, 30);
+
+    vmmc::CallbackFunctions callbacks = bindCallbacks(model);
+
+    vmmc::VMMC vmmc(nParticles, 3, &system.coordinates[0], &system.orientations[0],
+        0.15, 0.2, 0.5, 0.5, 30, &system.boxSize[0], system.isIsotropic.get(), false, callbacks);
+
+    vmmc.rng.setSeed(42);
+    vmmc.setEnergyQuantum(quantum);
+    vmmc += 20000;
+
+    particles = system.particles;
+
+    return vmmc.getAccepts();
+}
+
+//! Check that the discrete energy path gives exactly the same trajectory as continuous energies.
+static bool checkDiscreteEnergies()
+{
+    std::vector<Particle> continuous, discrete, fine;
+
+    // The finest quantum puts every well beyond the table of Boltzmann factors.
+    unsigned long long nContinuous = runDiscreteEnergies(0, continuous);
+    unsigned long long nDiscrete = runDiscreteEnergies(1.0, discrete);
+    unsigned long long nFine = runDiscreteEnergies(2.0/1499, fine);
+
+    bool isPassed = (nDiscrete == nContinuous) && (nFine == nContinuous);
+
+    for (unsigned int i=0;i<continuous.size();i++)
+    {
+        if ((continuous[i].position != discrete[i].position) || (continuous[i].position != fine[i].position))
+            isPassed = false;
+    }
+
+    char details[256];
+    sprintf(details, "%llu, %llu, and %llu accepted moves", nContinuous, nDiscrete, nFine);
+
+    return report("discrete energy trajectory", isPassed, details);
+}
+
+//! Evaluate a natural cubic spline through uniformly spaced samples.
+/*! The second derivatives are found by Gaussian elimination of the full
+    linear system, independently of the tridiagonal solver in TabulatedModel.
+ */
+static double evaluateSpline(const std::vector<double>& x, const std::vector<double>& y, double value)
+{
+    unsigned int n = x.size();
+    double h = x[1] - x[0];
+
+    // Build the system for the interior second derivatives.
+    unsigned int m = n - 2;
+    std::vector<std::vector<double> > a(m, std::vector<double>(m + 1, 0));
+    for (unsigned int i=0;i<m;i++)
+    {
+        a[i][i] = 4;
+        if (i > 0) a[i][i-1] = 1;
+        if (i < m-1) a[i][i+1] = 1;
+        a[i][m] = 6*(y[i+2] - 2*y[i+1] + y[i])/(h*h);
+    }
+
+    for (unsigned int i=0;i<m;i++)
+    {
+        for (unsigned int j=i+1;j<m;j++)
+        {
+            double factor = a[j][i]/a[i][i];
+            for (unsigned int k=i;k<=m;k++) a[j][k] -= factor*a[i][k];
+        }
+    }
+
+    std::vector<double> y2(n, 0);
+    for (int i=m-1;i>=0;i--)
+    {
+        double sum = a[i][m];
+        for (unsigned int k=i+1;k<m;k++) sum -= a[i][k]*y2[k+1];
+        y2[i+1] = sum/a[i][i];
+    }
+
+    unsigned int k = std::min((unsigned int) ((value - x[0])/h), n - 2);
+    double t = (value - x[k])/h;
+
+    return (1 - t)*y[k] + t*y[k+1] + ((1 - t)*((1 - t)*(1 - t) - 1)*y2[k] + t*(t*t - 1)*y2[k+1])*h*h/6;
+}
+
+//! Check the precomputed spline and linear coefficients of the tabulated potential.
+static bool checkSpline()
+{
+    System system(3, 2, 0.01, 1.1);
+
+    MersenneTwister rng(42);
+    bool isPassed = true;
+    double maxError = 0;
+
+    // Samples at uniformly spaced squared separations.
+    unsigned int nSamples = 11;
+    std::vector<double> squaredSeparations(nSamples);
+    std::vector<double> linear(nSamples);
+    std::vector<double> smooth(nSamples);
+
+    for (unsigned int i=0;i<nSamples;i++)
+    {
+        double x = 1.0 + 0.021*i;
+        squaredSeparations[i] = x;
+        linear[i] = 2.0 - 3.0*x;
+        smooth[i] = std::exp(-5*(x - 1))*std::cos(10*x);
+    }
+    squaredSeparations.back() = 1.21;
+
+    // Both schemes reproduce a linear potential, however finely it is resampled.
+    TabulatedModel lineModel(system.box, system.particles, system.cells, 10,
+        squaredSeparations, linear, TabulatedModel::LINEAR, 1000);
+    TabulatedModel splineLineModel(system.box, system.particles, system.cells, 10,
+        squaredSeparations, linear, TabulatedModel::SPLINE, 1000);
+
+    // With one bin per sample, the table is the natural spline through the samples.
+    TabulatedModel splineModel(system.box, system.particles, system.cells, 10,
+        squaredSeparations, smooth, TabulatedModel::SPLINE, nSamples - 1);
+
+    for (unsigned int i=0;i<10000;i++)
+    {
+        double x = 1.0 + 0.21*rng();
+
+        maxError = std::max(maxError, std::abs(lineModel.computeTabulatedEnergy(x) - (2.0 - 3.0*x)));
+        maxError = std::max(maxError, std::abs(splineLineModel.computeTabulatedEnergy(x) - (2.0 - 3.0*x)));
+        maxError = std::max(maxError, std::abs(splineModel.computeTabulatedEnergy(x)
+            - evaluateSpline(squaredSeparations, smooth, x)));
+    }
+
+    if (maxError > 1e-10) isPassed = false;
+
+    // Hard core below the first sample, and no interaction beyond the last.
+    if ((splineModel.computeTabulatedEnergy(0.999) != INF) || (splineModel.computeTabulatedEnergy(1.2101) != 0))
+        isPassed = false;
+
+    char details[256];
+    sprintf(details, "maximum error %.2e", maxError);
+
+    return report("tabulated spline coefficients", isPassed, details);
+}
+
+int main(int argc, char** argv)
+{
+    bool isPassed = true;
+
+    // Run every check, even if an earlier one fails.
+    isPassed &= checkClusterTracker();
+    isPassed &= checkAggregationVolumeBias();
+    isPassed &= checkSwapMoves();
+    isPassed &= checkVolumeMoves();
+    isPassed &= checkPolydisperseCells();
+    isPassed &= checkMixtureTable();
+    isPassed &= checkPatchySpheres();
+    isPassed &= checkRods();
+    isPassed &= checkCoordinationCache();
+    isPassed &= checkDiscreteEnergies();
+    isPassed &= checkSpline();
+
+    if (!isPassed)
+    {
+        std::cout << "\nSome checks failed!\n";
+        return (EXIT_FAILURE);
+    }
+
+    std::cout << "\nAll checks passed!\n";
+
+    // We're done!
+    return (EXIT_SUCCESS);
+}
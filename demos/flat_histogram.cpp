@@ -0,0 +1,218 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "Demo.h"
+#include "VMMC.h"
+
+#ifndef M_PI
+    #define M_PI 3.1415926535897932384626433832795
+#endif
+
+// Free-energy profile of the largest cluster size in a two dimensional
+// square-well fluid, computed using Wang-Landau sampling in overlapping
+// windows. Each window is sampled by an independent walker, run in
+// parallel on its own thread.
+
+int main(int argc, char** argv)
+{
+    // Simulation parameters.
+    unsigned int dimension = 2;                     // dimension of simulation box
+    unsigned int nParticles = 24;                   // number of particles
+    double interactionEnergy = 2.0;                 // pair interaction energy scale (in units of kBT)
+    double interactionRange = 1.1;                  // size of interaction range (in units of particle diameter)
+    double density = 0.05;                          // particle density
+    double baseLength;                              // base length of simulation box
+    unsigned int maxInteractions = 10;              // maximum number of interactions per particle
+
+    // Sampling windows (the collective variable is the largest cluster size).
+    unsigned int nWindows = 3;                      // number of windows
+    unsigned int windowSize = 10;                   // number of cluster sizes in each window
+    unsigned int windowOverlap = 3;                 // number of cluster sizes shared by adjacent windows
+
+    // Work out base length of simulation box (particle diameter is one).
+    if (dimension == 2) baseLength = std::pow((nParticles*M_PI)/(4.0*density), 1.0/2.0);
+    else baseLength = std::pow((nParticles*M_PI)/(6.0*density), 1.0/3.0);
+
+    std::vector<double> boxSize;
+    for (unsigned int i=0;i<dimension;i++)
+        boxSize.push_back(baseLength);
+
+    // Per-walker data structures.
+    std::vector<std::vector<Particle> > particles(nWindows, std::vector<Particle>(nParticles));
+    std::vector<CellList> cells(nWindows);
+    std::vector<Box*> boxes(nWindows);
+    std::vector<SquareWellium*> models(nWindows);
+    std::vector<ClusterTracker*> clusterTrackers(nWindows);
+    std::vector<FlatHistogram*> flatHistograms(nWindows);
+    std::vector<vmmc::VMMC*> walkers(nWindows);
+
+    // Initialise random number generator.
+    MersenneTwister rng;
+
+    // Initialise particle initialisation object.
+    Initialise initialise;
+
+    // Set up the walkers.
+    for (unsigned int i=0;i<nWindows;i++)
+    {
+        // Initialise simulation box object.
+        boxes[i] = new Box(boxSize);
+
+        // Initialise cell list.
+        cells[i].setDimension(dimension);
+        cells[i].initialise(boxes[i]->boxSize, interactionRange);
+
+        // Initialise the square well potential model.
+        models[i] = new SquareWellium(*boxes[i], particles[i], cells[i],
+            maxInteractions, interactionEnergy, interactionRange);
+
+        // Generate a random particle configuration.
+        initialise.random(particles[i], cells[i], *boxes[i], rng, false);
+
+        // Initialise the cluster tracker.
+        clusterTrackers[i] = new ClusterTracker(*models[i]);
+
+        // Window edges, with one bin per cluster size.
+        unsigned int minimum = 1 + i*(windowSize - windowOverlap);
+        unsigned int maximum = std::min(minimum + windowSize, nParticles + 1);
+
+        // Initialise the flat-histogram sampler.
+        flatHistograms[i] = new FlatHistogram(*clusterTrackers[i], FlatHistogram::LARGEST_CLUSTER,
+            minimum, maximum, maximum - minimum, 1.0, 1e-3);
+
+        // Initialise data structures needed by the VMMC class.
+        double coordinates[dimension*nParticles];
+#ifndef ISOTROPIC
+        double orientations[dimension*nParticles];
+        bool isIsotropic[nParticles];
+#endif
+
+        // Copy particle coordinates and orientations into C-style arrays.
+        for (unsigned int j=0;j<nParticles;j++)
+        {
+            for (unsigned int k=0;k<dimension;k++)
+            {
+                coordinates[dimension*j + k] = particles[i][j].position[k];
+#ifndef ISOTROPIC
+                orientations[dimension*j + k] = particles[i][j].orientation[k];
+#endif
+            }
+
+#ifndef ISOTROPIC
+            // Set all particles as isotropic.
+            isIsotropic[j] = true;
+#endif
+        }
+
+        // Initialise the VMMC callback functions.
+        using namespace std::placeholders;
+        vmmc::CallbackFunctions callbacks;
+#ifndef ISOTROPIC
+        callbacks.energyCallback =
+            std::bind(&SquareWellium::computeEnergy, models[i], _1, _2, _3);
+        callbacks.pairEnergyCallback =
+            std::bind(&SquareWellium::computePairEnergy, models[i], _1, _2, _3, _4, _5, _6);
+        callbacks.interactionsCallback =
+            std::bind(&SquareWellium::computeInteractions, models[i], _1, _2, _3, _4);
+        callbacks.postMoveCallback =
+            std::bind(&SquareWellium::applyPostMoveUpdates, models[i], _1, _2, _3);
+#else
+        callbacks.energyCallback =
+            std::bind(&SquareWellium::computeEnergy, models[i], _1, _2);
+        callbacks.pairEnergyCallback =
+            std::bind(&SquareWellium::computePairEnergy, models[i], _1, _2, _3, _4);
+        callbacks.interactionsCallback =
+            std::bind(&SquareWellium::computeInteractions, models[i], _1, _2, _3);
+        callbacks.postMoveCallback =
+            std::bind(&SquareWellium::applyPostMoveUpdates, models[i], _1, _2);
+#endif
+        callbacks.biasCallback =
+            std::bind(&FlatHistogram::bias, flatHistograms[i], _1, _2);
+        callbacks.observerCallback =
+            std::bind(&FlatHistogram::observe, flatHistograms[i], _1, _2, _3);
+
+        // Initialise VMMC object.
+#ifndef ISOTROPIC
+        walkers[i] = new vmmc::VMMC(nParticles, dimension, coordinates, orientations,
+            0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], isIsotropic, false, callbacks);
+#else
+        walkers[i] = new vmmc::VMMC(nParticles, dimension, coordinates,
+            0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], false, callbacks);
+#endif
+    }
+
+    // Run the walkers until the weights in every window have converged,
+    // followed by a multicanonical production run.
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+
+    for (unsigned int i=0;i<nWindows;i++)
+    {
+        threads.push_back(std::thread([&, i]
+        {
+            unsigned int nProduction = 0;
+
+            while (nProduction < 1000)
+            {
+                // Increment simulation by 100 Monte Carlo Sweeps.
+                *walkers[i] += 100*nParticles;
+
+                if (flatHistograms[i]->isConverged()) nProduction++;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            printf("window = %d, iterations = %d, ln f = %5.4e\n", i,
+                flatHistograms[i]->getNumIterations(), flatHistograms[i]->getModificationFactor());
+        }));
+    }
+
+    for (unsigned int i=0;i<nWindows;i++)
+        threads[i].join();
+
+    // Stitch together the windows.
+    std::vector<const FlatHistogram*> windows(flatHistograms.begin(), flatHistograms.end());
+    std::vector<double> centres, freeEnergy;
+    FlatHistogram::merge(windows, centres, freeEnergy);
+
+    // Write the free-energy profile to file.
+    FILE *pFile = fopen("free_energy.txt", "w");
+    for (unsigned int i=0;i<centres.size();i++)
+        fprintf(pFile, "%d %.8e\n", (int) centres[i], freeEnergy[i]);
+    fclose(pFile);
+
+    // Clean up.
+    for (unsigned int i=0;i<nWindows;i++)
+    {
+        delete walkers[i];
+        delete flatHistograms[i];
+        delete clusterTrackers[i];
+        delete models[i];
+        delete boxes[i];
+    }
+
+    std::cout << "\nComplete!\n";
+
+    // We're done!
+    return (EXIT_SUCCESS);
+}
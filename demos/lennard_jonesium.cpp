@@ -137,6 +137,13 @@ int main(int argc, char** argv)
         0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], true, callbacks);
 #endif
 
+    // Initialise the mean-squared displacement accumulator (sampled every 1000 sweeps).
+    MeanSquaredDisplacement msd(nParticles, dimension, 1000);
+
+    // Sample the initial configuration.
+    vmmc.getUnwrappedCoordinates(coordinates);
+    msd.sample(coordinates);
+
     // Execute the simulation.
     for (unsigned int i=0;i<1000;i++)
     {
@@ -147,10 +154,17 @@ int main(int argc, char** argv)
         if (i == 0) io.appendXyzTrajectory(dimension, particles, true);
         else io.appendXyzTrajectory(dimension, particles, false);
 
+        // Accumulate the mean-squared displacement.
+        vmmc.getUnwrappedCoordinates(coordinates);
+        msd.sample(coordinates);
+
         // Report.
         printf("sweeps = %9.4e, energy = %5.4f\n", ((double) (i+1)*1000), lennardJonesium.getEnergy());
     }
 
+    // Write the mean-squared displacement to file.
+    msd.save("msd.txt");
+
     std::cout << "\nComplete!\n";
 
     // We're done!
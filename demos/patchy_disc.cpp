@@ -101,6 +101,9 @@ int main(int argc, char** argv)
         isIsotropic[i] = false;
     }
 
+    // Initialise the cluster tracker.
+    ClusterTracker clusterTracker(patchyDisc);
+
     // Initialise the VMMC callback functions.
     using namespace std::placeholders;
     vmmc::CallbackFunctions callbacks;
@@ -113,6 +116,8 @@ int main(int argc, char** argv)
         std::bind(&PatchyDisc::computeInteractions, patchyDisc, _1, _2, _3, _4);
     callbacks.postMoveCallback =
         std::bind(&PatchyDisc::applyPostMoveUpdates, patchyDisc, _1, _2, _3);
+    callbacks.observerCallback =
+        std::bind(&ClusterTracker::observe, &clusterTracker, _1, _2, _3);
 #else
     callbacks.energyCallback =
         std::bind(&PatchyDisc::computeEnergy, patchyDisc, _1, _2);
@@ -122,26 +127,42 @@ int main(int argc, char** argv)
         std::bind(&PatchyDisc::computeInteractions, patchyDisc, _1, _2, _3);
     callbacks.postMoveCallback =
         std::bind(&PatchyDisc::applyPostMoveUpdates, patchyDisc, _1, _2);
+    callbacks.observerCallback =
+        std::bind(&ClusterTracker::observe, &clusterTracker, _1, _2, _3);
 #endif
 
     // Initialise VMMC object.
     vmmc::VMMC vmmc(nParticles, dimension, coordinates, orientations,
         0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], isIsotropic, false, callbacks);
 
+    // Pair energies only take discrete values, so avoid computing exponentials.
+    vmmc.setEnergyQuantum(interactionEnergy);
+
+    // Initialise the energy autocorrelation function (sampled every 10 sweeps).
+    Correlator correlator(10);
+
     // Execute the simulation.
     for (unsigned int i=0;i<1000;i++)
     {
-        // Increment simulation by 1000 Monte Carlo Sweeps.
-        vmmc += 1000*nParticles;
+        // Increment simulation by 1000 Monte Carlo Sweeps, sampling the energy.
+        for (unsigned int j=0;j<100;j++)
+        {
+            vmmc += 10*nParticles;
+            correlator.sample(patchyDisc.getEnergy());
+        }
 
         // Append particle coordinates to an xyz trajectory.
         if (i == 0) io.appendXyzTrajectory(dimension, particles, true);
         else io.appendXyzTrajectory(dimension, particles, false);
 
         // Report.
-        printf("sweeps = %9.4e, energy = %5.4f\n", ((double) (i+1)*1000), patchyDisc.getEnergy());
+        printf("sweeps = %9.4e, energy = %5.4f, largest cluster = %u\n", ((double) (i+1)*1000),
+            patchyDisc.getEnergy(), clusterTracker.getLargestClusterSize());
     }
 
+    // Write the normalised energy autocorrelation function to file.
+    correlator.save("correlation.txt", true);
+
     std::cout << "\nComplete!\n";
 
     // We're done!
@@ -0,0 +1,155 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef ISOTROPIC
+#error patchy_sphere.cpp cannot be linked to isotropic VMMC library!
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "Demo.h"
+#include "VMMC.h"
+
+#ifndef M_PI
+    #define M_PI 3.1415926535897932384626433832795
+#endif
+
+int main(int argc, char** argv)
+{
+    // Simulation parameters.
+    unsigned int dimension = 3;                     // dimension of simulation box
+    unsigned int nParticles = 1000;                 // number of particles
+    double interactionEnergy = 7.0;                 // patch interaction energy scale (in units of kBT)
+    double interactionRange = 1.12;                 // centre-centre interaction range (in units of particle diameter)
+    double patchAngle = 0.4;                        // patch half-angle (in radians)
+    double density = 0.1;                           // particle density
+    double baseLength;                              // base length of simulation box
+    unsigned int maxInteractions = 4;               // maximum number of interactions per particle (number of patches)
+
+    // Data structures.
+    std::vector<Particle> particles(nParticles);    // particle container
+    CellList cells;                                 // cell list
+    bool isIsotropic[nParticles];                   // whether the potential of each particle is isotropic
+
+    // Four patches arranged tetrahedrally in the body frame.
+    std::vector<std::vector<double> > patchDirections(4, std::vector<double>(3));
+    double tetrahedron[4][3] = {{1, 1, 1}, {1, -1, -1}, {-1, 1, -1}, {-1, -1, 1}};
+    for (unsigned int i=0;i<4;i++)
+        for (unsigned int j=0;j<3;j++)
+            patchDirections[i][j] = tetrahedron[i][j];
+
+    // Work out base length of simulation box (particle diameter is one).
+    baseLength = std::pow((nParticles*M_PI)/(6.0*density), 1.0/3.0);
+
+    std::vector<double> boxSize;
+    for (unsigned int i=0;i<dimension;i++)
+        boxSize.push_back(baseLength);
+
+    // Initialise simulation box object.
+    Box box(boxSize);
+
+    // Initialise input/output class,
+    InputOutput io;
+
+    // Create VMD script.
+    io.vmdScript(boxSize);
+
+    // Initialise cell list.
+    cells.setDimension(dimension);
+    cells.initialise(box.boxSize, interactionRange);
+
+    // Initialise the patchy sphere model.
+    PatchySphere patchySphere(box, particles, cells, maxInteractions,
+        interactionEnergy, interactionRange, patchDirections, patchAngle);
+
+    // Initialise random number generator.
+    MersenneTwister rng;
+
+    // Initialise particle initialisation object.
+    Initialise initialise;
+
+    // Generate a random particle configuration.
+    initialise.random(particles, cells, box, rng, false);
+
+    // Set up the body frame and patches of each particle.
+    patchySphere.initialisePatches();
+
+    // Initialise data structures needed by the VMMC class.
+    double coordinates[dimension*nParticles];
+    double orientations[dimension*nParticles];
+
+    // Copy particle coordinates and orientations into C-style arrays.
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        for (unsigned int j=0;j<dimension;j++)
+        {
+            coordinates[dimension*i + j] = particles[i].position[j];
+            orientations[dimension*i + j] = particles[i].orientation[j];
+        }
+
+        // Set all particles as anisotropic.
+        isIsotropic[i] = false;
+    }
+
+    // Initialise the cluster tracker.
+    ClusterTracker clusterTracker(patchySphere);
+
+    // Initialise the VMMC callback functions (bound to a pointer, since the
+    // model caches the patch vectors of each particle).
+    using namespace std::placeholders;
+    vmmc::CallbackFunctions callbacks;
+    callbacks.energyCallback =
+        std::bind(&PatchySphere::computeEnergy, &patchySphere, _1, _2, _3);
+    callbacks.pairEnergyCallback =
+        std::bind(&PatchySphere::computePairEnergy, &patchySphere, _1, _2, _3, _4, _5, _6);
+    callbacks.interactionsCallback =
+        std::bind(&PatchySphere::computeInteractions, &patchySphere, _1, _2, _3, _4);
+    callbacks.postMoveCallback =
+        std::bind(&PatchySphere::applyPostMoveUpdates, &patchySphere, _1, _2, _3);
+    callbacks.observerCallback =
+        std::bind(&ClusterTracker::observe, &clusterTracker, _1, _2, _3);
+
+    // Initialise VMMC object.
+    vmmc::VMMC vmmc(nParticles, dimension, coordinates, orientations,
+        0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], isIsotropic, false, callbacks);
+
+    // Rotate the body frames rigidly with cluster rotations.
+    patchySphere.setEngine(vmmc);
+
+    // Execute the simulation.
+    for (unsigned int i=0;i<1000;i++)
+    {
+        // Increment simulation by 1000 Monte Carlo Sweeps.
+        vmmc += 1000*nParticles;
+
+        // Append particle coordinates to an xyz trajectory.
+        if (i == 0) io.appendXyzTrajectory(dimension, particles, true);
+        else io.appendXyzTrajectory(dimension, particles, false);
+
+        // Report.
+        printf("sweeps = %9.4e, energy = %5.4f, largest cluster = %u\n", ((double) (i+1)*1000),
+            patchySphere.getEnergy(), clusterTracker.getLargestClusterSize());
+    }
+
+    std::cout << "\nComplete!\n";
+
+    // We're done!
+    return (EXIT_SUCCESS);
+}
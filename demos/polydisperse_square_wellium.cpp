@@ -0,0 +1,178 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "Demo.h"
+#include "VMMC.h"
+
+#ifndef M_PI
+    #define M_PI 3.1415926535897932384626433832795
+#endif
+
+// A polydisperse square-well fluid containing a small number of large
+// particles. Neighbours are found using a multi-level cell list, and size
+// swap moves are used to relax the size distribution of the small particles.
+
+int main(int argc, char** argv)
+{
+    // Simulation parameters.
+    unsigned int dimension = 3;                     // dimension of simulation box
+    unsigned int nParticles = 1000;                 // number of particles
+    unsigned int nLarge = 10;                       // number of large particles
+    double largeRadius = 2.0;                       // radius of the large particles
+    double polydispersity = 0.1;                    // relative width of the small particle size distribution
+    double interactionEnergy = 1.5;                 // pair interaction energy scale (in units of kBT)
+    double interactionRange = 1.1;                  // size of interaction range (in units of the contact distance)
+    double packingFraction = 0.1;                   // particle packing fraction
+    double baseLength;                              // base length of simulation box
+    unsigned int maxInteractions = 100;             // maximum number of interactions per particle
+    double probSwap = 0.1;                          // probability of attempting a size swap move
+
+    // Data structures.
+    std::vector<Particle> particles(nParticles);    // particle container
+    MultiCellList multiCells;                       // multi-level cell list
+#ifndef ISOTROPIC
+    bool isIsotropic[nParticles];                   // whether the potential of each particle is isotropic
+#endif
+
+    // Initialise random number generator.
+    MersenneTwister rng;
+
+    // Assign particle radii: the small particles are uniformly distributed
+    // about a mean radius of one half.
+    double volume = 0;
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        if (i < nLarge) particles[i].radius = largeRadius;
+        else particles[i].radius = 0.5*(1.0 + polydispersity*(2*rng() - 1));
+
+        if (dimension == 2) volume += M_PI*particles[i].radius*particles[i].radius;
+        else volume += (4.0/3.0)*M_PI*particles[i].radius*particles[i].radius*particles[i].radius;
+    }
+
+    // Work out base length of simulation box.
+    baseLength = std::pow(volume/packingFraction, 1.0/dimension);
+
+    std::vector<double> boxSize;
+    for (unsigned int i=0;i<dimension;i++)
+        boxSize.push_back(baseLength);
+
+    // Initialise simulation box object.
+    Box box(boxSize);
+
+    // Initialise input/output class,
+    InputOutput io;
+
+    // Create VMD script.
+    io.vmdScript(boxSize);
+
+    // Initialise the multi-level cell list (this must be done before creating the model).
+    multiCells.setDimension(dimension);
+    multiCells.initialise(box.boxSize, particles, interactionRange);
+
+    // Initialise the polydisperse square well potential model.
+    PolydisperseSquareWellium squareWellium(box, particles, multiCells,
+        maxInteractions, interactionEnergy, interactionRange);
+
+    // Initialise particle initialisation object.
+    Initialise initialise;
+
+    // Generate a random particle configuration.
+    initialise.random(particles, multiCells, box, rng);
+
+    // Initialise data structures needed by the VMMC class.
+    double coordinates[dimension*nParticles];
+#ifndef ISOTROPIC
+    double orientations[dimension*nParticles];
+#endif
+
+    // Copy particle coordinates and orientations into C-style arrays.
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        for (unsigned int j=0;j<dimension;j++)
+        {
+            coordinates[dimension*i + j] = particles[i].position[j];
+#ifndef ISOTROPIC
+            orientations[dimension*i + j] = particles[i].orientation[j];
+#endif
+        }
+
+#ifndef ISOTROPIC
+        // Set all particles as isotropic.
+        isIsotropic[i] = true;
+#endif
+    }
+
+    // Initialise the VMMC callback functions.
+    using namespace std::placeholders;
+    vmmc::CallbackFunctions callbacks;
+#ifndef ISOTROPIC
+    callbacks.energyCallback =
+        std::bind(&PolydisperseSquareWellium::computeEnergy, squareWellium, _1, _2, _3);
+    callbacks.pairEnergyCallback =
+        std::bind(&PolydisperseSquareWellium::computePairEnergy, squareWellium, _1, _2, _3, _4, _5, _6);
+    callbacks.interactionsCallback =
+        std::bind(&PolydisperseSquareWellium::computeInteractions, squareWellium, _1, _2, _3, _4);
+    callbacks.postMoveCallback =
+        std::bind(&PolydisperseSquareWellium::applyPostMoveUpdates, squareWellium, _1, _2, _3);
+#else
+    callbacks.energyCallback =
+        std::bind(&PolydisperseSquareWellium::computeEnergy, squareWellium, _1, _2);
+    callbacks.pairEnergyCallback =
+        std::bind(&PolydisperseSquareWellium::computePairEnergy, squareWellium, _1, _2, _3, _4);
+    callbacks.interactionsCallback =
+        std::bind(&PolydisperseSquareWellium::computeInteractions, squareWellium, _1, _2, _3);
+    callbacks.postMoveCallback =
+        std::bind(&PolydisperseSquareWellium::applyPostMoveUpdates, squareWellium, _1, _2);
+#endif
+
+    // Initialise VMMC object.
+#ifndef ISOTROPIC
+    vmmc::VMMC vmmc(nParticles, dimension, coordinates, orientations,
+        0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], isIsotropic, false, callbacks);
+#else
+    vmmc::VMMC vmmc(nParticles, dimension, coordinates,
+        0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], false, callbacks);
+#endif
+
+    // Swap the positions (and hence the sizes) of pairs of particles.
+    vmmc.setSwapMoves(probSwap);
+
+    // Execute the simulation.
+    for (unsigned int i=0;i<1000;i++)
+    {
+        // Increment simulation by 1000 Monte Carlo Sweeps.
+        vmmc += 1000*nParticles;
+
+        // Append particle coordinates to an xyz trajectory.
+        if (i == 0) io.appendXyzTrajectory(dimension, particles, true);
+        else io.appendXyzTrajectory(dimension, particles, false);
+
+        // Report.
+        printf("sweeps = %9.4e, energy = %5.4f, swap acceptance = %5.4f\n", ((double) (i+1)*1000),
+            squareWellium.getEnergy(), ((double) vmmc.getSwapAccepts())/vmmc.getSwapAttempts());
+    }
+
+    std::cout << "\nComplete!\n";
+
+    // We're done!
+    return (EXIT_SUCCESS);
+}
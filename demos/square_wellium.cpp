@@ -102,6 +102,9 @@ int main(int argc, char** argv)
 #endif
     }
 
+    // Initialise the bond-orientational order parameter object (updated incrementally).
+    BondOrder bondOrder(squareWellium, true);
+
     // Initialise the VMMC callback functions.
     using namespace std::placeholders;
     vmmc::CallbackFunctions callbacks;
@@ -124,6 +127,8 @@ int main(int argc, char** argv)
     callbacks.postMoveCallback =
         std::bind(&SquareWellium::applyPostMoveUpdates, squareWellium, _1, _2);
 #endif
+    callbacks.observerCallback =
+        std::bind(&BondOrder::observe, &bondOrder, _1, _2, _3);
 
     // Initialise VMMC object.
 #ifndef ISOTROPIC
@@ -134,6 +139,9 @@ int main(int argc, char** argv)
         0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], false, callbacks);
 #endif
 
+    // Pair energies only take discrete values, so avoid computing exponentials.
+    vmmc.setEnergyQuantum(interactionEnergy);
+
     // Execute the simulation.
     for (unsigned int i=0;i<1000;i++)
     {
@@ -144,8 +152,12 @@ int main(int argc, char** argv)
         if (i == 0) io.appendXyzTrajectory(dimension, particles, true);
         else io.appendXyzTrajectory(dimension, particles, false);
 
+        // Update the bond-orientational order parameters.
+        bondOrder.compute();
+
         // Report.
-        printf("sweeps = %9.4e, energy = %5.4f\n", ((double) (i+1)*1000), squareWellium.getEnergy());
+        printf("sweeps = %9.4e, energy = %5.4f, %s = %5.4f\n", ((double) (i+1)*1000), squareWellium.getEnergy(),
+            (dimension == 3) ? "q6" : "psi6", (dimension == 3) ? bondOrder.getQ6() : bondOrder.getPsi6());
     }
 
     std::cout << "\nComplete!\n";
@@ -0,0 +1,149 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef ISOTROPIC
+#error square_wellium_rod.cpp cannot be linked to isotropic VMMC library!
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "Demo.h"
+#include "VMMC.h"
+
+int main(int argc, char** argv)
+{
+    // Simulation parameters.
+    unsigned int dimension = 3;                     // dimension of simulation box
+    unsigned int nParticles = 1000;                 // number of particles
+    double interactionEnergy = 1.5;                 // pair interaction energy scale (in units of kBT)
+    double interactionRange = 1.3;                  // size of interaction range (in units of rod diameter)
+    double length = 3.0;                            // length of the rod axis (in units of rod diameter)
+    double density = 0.01;                          // number density of rods
+    double baseLength;                              // base length of simulation box
+    unsigned int maxInteractions = 20;              // maximum number of interactions per particle
+
+    // Data structures.
+    std::vector<Particle> particles(nParticles);    // particle container
+    CellList cells;                                 // cell list
+    bool isIsotropic[nParticles];                   // whether the potential of each particle is isotropic
+
+    // Work out base length of simulation box.
+    baseLength = std::pow(nParticles/density, 1.0/3.0);
+
+    std::vector<double> boxSize;
+    for (unsigned int i=0;i<dimension;i++)
+        boxSize.push_back(baseLength);
+
+    // Initialise simulation box object.
+    Box box(boxSize);
+
+    // Initialise input/output class,
+    InputOutput io;
+
+    // Create VMD script.
+    io.vmdScript(boxSize);
+
+    // Initialise cell list (rods interact if their centres are within length + interactionRange).
+    cells.setDimension(dimension);
+    cells.initialise(box.boxSize, length + interactionRange);
+
+    // Initialise the square well rod model.
+    SquareWelliumRod squareWelliumRod(box, particles, cells,
+        maxInteractions, interactionEnergy, interactionRange, length);
+
+    // Place the rods on a cubic lattice, aligned along the z axis.
+    unsigned int nSide = std::ceil(std::pow(nParticles, 1.0/3.0));
+    double spacing = baseLength/nSide;
+
+    if (spacing <= (length + 1))
+    {
+        std::cerr << "[ERROR] Density is too high for the initial lattice!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        particles[i].index = i;
+        particles[i].position.resize(dimension);
+        particles[i].orientation.resize(dimension);
+
+        particles[i].position[0] = spacing*(0.5 + (i % nSide));
+        particles[i].position[1] = spacing*(0.5 + ((i/nSide) % nSide));
+        particles[i].position[2] = spacing*(0.5 + (i/(nSide*nSide)));
+
+        particles[i].orientation[0] = 0;
+        particles[i].orientation[1] = 0;
+        particles[i].orientation[2] = 1;
+    }
+
+    cells.initCellList(particles);
+
+    // Initialise data structures needed by the VMMC class.
+    double coordinates[dimension*nParticles];
+    double orientations[dimension*nParticles];
+
+    // Copy particle coordinates and orientations into C-style arrays.
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        for (unsigned int j=0;j<dimension;j++)
+        {
+            coordinates[dimension*i + j] = particles[i].position[j];
+            orientations[dimension*i + j] = particles[i].orientation[j];
+        }
+
+        // Set all particles as anisotropic.
+        isIsotropic[i] = false;
+    }
+
+    // Initialise the VMMC callback functions.
+    using namespace std::placeholders;
+    vmmc::CallbackFunctions callbacks;
+    callbacks.energyCallback =
+        std::bind(&SquareWelliumRod::computeEnergy, squareWelliumRod, _1, _2, _3);
+    callbacks.pairEnergyCallback =
+        std::bind(&SquareWelliumRod::computePairEnergy, squareWelliumRod, _1, _2, _3, _4, _5, _6);
+    callbacks.interactionsCallback =
+        std::bind(&SquareWelliumRod::computeInteractions, squareWelliumRod, _1, _2, _3, _4);
+    callbacks.postMoveCallback =
+        std::bind(&SquareWelliumRod::applyPostMoveUpdates, squareWelliumRod, _1, _2, _3);
+
+    // Initialise VMMC object (the reference radius encloses the rod).
+    vmmc::VMMC vmmc(nParticles, dimension, coordinates, orientations,
+        0.15, 0.2, 0.5, 0.5*(length + 1), maxInteractions, &boxSize[0], isIsotropic, false, callbacks);
+
+    // Execute the simulation.
+    for (unsigned int i=0;i<1000;i++)
+    {
+        // Increment simulation by 1000 Monte Carlo Sweeps.
+        vmmc += 1000*nParticles;
+
+        // Append particle coordinates to an xyz trajectory.
+        if (i == 0) io.appendXyzTrajectory(dimension, particles, true);
+        else io.appendXyzTrajectory(dimension, particles, false);
+
+        // Report.
+        printf("sweeps = %9.4e, energy = %5.4f\n", ((double) (i+1)*1000), squareWelliumRod.getEnergy());
+    }
+
+    std::cout << "\nComplete!\n";
+
+    // We're done!
+    return (EXIT_SUCCESS);
+}
@@ -151,6 +151,9 @@ int main(int argc, char** argv)
         0.15, 0.2, 0.5, 0.5, maxInteractions, &boxSize[0], false, callbacks);
 #endif
 
+    // Pair and wall energies are multiples of 0.1, so avoid computing exponentials.
+    vmmc.setEnergyQuantum(0.1);
+
     // Execute the simulation.
     for (unsigned int i=0;i<1000;i++)
     {
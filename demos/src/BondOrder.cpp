@@ -0,0 +1,492 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include "BondOrder.h"
+#include "Box.h"
+#include "Model.h"
+#include "Particle.h"
+
+#ifndef M_PI
+    #define M_PI 3.1415926535897932384626433832795
+#endif
+
+BondOrder::BondOrder(Model& model_, bool isIncremental_) :
+    model(model_),
+    isIncremental(isIncremental_),
+    Q4(0),
+    Q6(0),
+    Psi6(0)
+{
+    nParticles = model.particles.size();
+    dimension = model.box.dimension;
+
+    if ((dimension != 2) && (dimension != 3))
+    {
+        std::cerr << "[ERROR] BondOrder: Dimension must be two or three!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Allocate memory.
+    neighbours.resize(nParticles);
+    nNeighbours.resize(nParticles);
+    isDirty.resize(nParticles);
+    isMoved.resize(nParticles);
+
+    if (dimension == 3)
+    {
+        q4Re.resize(5*nParticles);
+        q4Im.resize(5*nParticles);
+        q6Re.resize(7*nParticles);
+        q6Im.resize(7*nParticles);
+        localQ4.resize(nParticles);
+        localQ6.resize(nParticles);
+    }
+    else
+    {
+        psi6Re.resize(nParticles);
+        psi6Im.resize(nParticles);
+        localPsi6.resize(nParticles);
+    }
+
+    // Flag all particles for the first evaluation.
+    invalidate();
+}
+
+void BondOrder::observe(unsigned int nMoving, const unsigned int* moveList, bool isAccepted)
+{
+    if (!isAccepted) return;
+
+    for (unsigned int i=0;i<nMoving;i++)
+    {
+        unsigned int particle = moveList[i];
+
+        flag(particle);
+
+        if (!isMoved[particle])
+        {
+            isMoved[particle] = true;
+            moved.push_back(particle);
+        }
+
+        // Former neighbours lose a bond.
+        for (unsigned int j=0;j<neighbours[particle].size();j++)
+            flag(neighbours[particle][j]);
+    }
+}
+
+void BondOrder::invalidate()
+{
+    for (unsigned int i=0;i<nParticles;i++)
+        flag(i);
+}
+
+void BondOrder::compute()
+{
+    // Make sure there is a workspace for each thread.
+#ifdef _OPENMP
+    unsigned int nThreads = omp_get_max_threads();
+#else
+    unsigned int nThreads = 1;
+#endif
+    if (workspaces.size() < nThreads)
+    {
+        unsigned int maxInteractions = model.getMaxInteractions();
+
+        workspaces.resize(nThreads);
+        for (unsigned int i=0;i<nThreads;i++)
+        {
+            workspaces[i].interactions.resize(maxInteractions);
+            workspaces[i].sep.resize(dimension);
+            workspaces[i].x.resize(maxInteractions);
+            workspaces[i].y.resize(maxInteractions);
+            workspaces[i].z.resize(maxInteractions);
+            workspaces[i].re.resize(maxInteractions);
+            workspaces[i].im.resize(maxInteractions);
+            workspaces[i].p0.resize(maxInteractions);
+            workspaces[i].p1.resize(maxInteractions);
+            workspaces[i].p2.resize(maxInteractions);
+        }
+    }
+
+    if (!isIncremental)
+    {
+        // Re-evaluate every particle.
+        if (dirty.size() < nParticles) invalidate();
+        evaluate(dirty, 0);
+    }
+    else
+    {
+        // Evaluate the flagged particles.
+        unsigned int nFlagged = dirty.size();
+        evaluate(dirty, 0);
+
+        // New neighbours of the moved particles gain a bond.
+        for (unsigned int i=0;i<moved.size();i++)
+        {
+            unsigned int particle = moved[i];
+            for (unsigned int j=0;j<neighbours[particle].size();j++)
+                flag(neighbours[particle][j]);
+        }
+
+        evaluate(dirty, nFlagged);
+    }
+
+    // Clear flags.
+    for (unsigned int i=0;i<dirty.size();i++)
+        isDirty[dirty[i]] = false;
+    for (unsigned int i=0;i<moved.size();i++)
+        isMoved[moved[i]] = false;
+    dirty.clear();
+    moved.clear();
+
+    reduce();
+}
+
+double BondOrder::getQ4() const
+{
+    if (dimension != 3)
+    {
+        std::cerr << "[ERROR] BondOrder: q4 is only defined in three dimensions!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    return Q4;
+}
+
+double BondOrder::getQ6() const
+{
+    if (dimension != 3)
+    {
+        std::cerr << "[ERROR] BondOrder: q6 is only defined in three dimensions!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    return Q6;
+}
+
+double BondOrder::getPsi6() const
+{
+    if (dimension != 2)
+    {
+        std::cerr << "[ERROR] BondOrder: psi6 is only defined in two dimensions!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    return Psi6;
+}
+
+const std::vector<double>& BondOrder::getLocalQ4() const
+{
+    return localQ4;
+}
+
+const std::vector<double>& BondOrder::getLocalQ6() const
+{
+    return localQ6;
+}
+
+const std::vector<double>& BondOrder::getLocalPsi6() const
+{
+    return localPsi6;
+}
+
+const std::vector<unsigned int>& BondOrder::getNumNeighbours() const
+{
+    return nNeighbours;
+}
+
+void BondOrder::flag(unsigned int particle)
+{
+    if (!isDirty[particle])
+    {
+        isDirty[particle] = true;
+        dirty.push_back(particle);
+    }
+}
+
+void BondOrder::evaluate(const std::vector<unsigned int>& list, unsigned int start)
+{
+    int size = list.size();
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (int i=start;i<size;i++)
+    {
+#ifdef _OPENMP
+        Workspace& workspace = workspaces[omp_get_thread_num()];
+#else
+        Workspace& workspace = workspaces[0];
+#endif
+        evaluate(list[i], workspace);
+    }
+}
+
+void BondOrder::evaluate(unsigned int particle, Workspace& workspace)
+{
+    const std::vector<double>& position = model.particles[particle].position;
+
+    // Find the neighbours of the particle.
+#ifndef ISOTROPIC
+    unsigned int n = model.computeInteractions(particle,
+        &position[0], &model.particles[particle].orientation[0], &workspace.interactions[0]);
+#else
+    unsigned int n = model.computeInteractions(particle, &position[0], &workspace.interactions[0]);
+#endif
+
+    neighbours[particle].assign(workspace.interactions.begin(), workspace.interactions.begin() + n);
+    nNeighbours[particle] = n;
+
+    // Compute unit bond vectors.
+    for (unsigned int i=0;i<n;i++)
+    {
+        const std::vector<double>& neighbour = model.particles[workspace.interactions[i]].position;
+
+        for (unsigned int j=0;j<dimension;j++)
+            workspace.sep[j] = neighbour[j] - position[j];
+
+        // Enforce minimum image.
+        model.box.minimumImage(workspace.sep);
+
+        workspace.x[i] = workspace.sep[0];
+        workspace.y[i] = workspace.sep[1];
+        workspace.z[i] = (dimension == 3) ? workspace.sep[2] : 0;
+    }
+
+    double* x = &workspace.x[0];
+    double* y = &workspace.y[0];
+    double* z = &workspace.z[0];
+
+    for (unsigned int i=0;i<n;i++)
+    {
+        double norm = 1.0/std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+        x[i] *= norm;
+        y[i] *= norm;
+        z[i] *= norm;
+    }
+
+    if (dimension == 3)
+    {
+        accumulateHarmonics(4, n, workspace, &q4Re[5*particle], &q4Im[5*particle]);
+        accumulateHarmonics(6, n, workspace, &q6Re[7*particle], &q6Im[7*particle]);
+    }
+    else
+    {
+        // Sum exp(6i theta) = (x + iy)^6 over bonds.
+        double sumRe = 0;
+        double sumIm = 0;
+
+        for (unsigned int i=0;i<n;i++)
+        {
+            double re2 = x[i]*x[i] - y[i]*y[i];
+            double im2 = 2*x[i]*y[i];
+            double re4 = re2*re2 - im2*im2;
+            double im4 = 2*re2*im2;
+            sumRe += re4*re2 - im4*im2;
+            sumIm += re4*im2 + im4*re2;
+        }
+
+        psi6Re[particle] = sumRe;
+        psi6Im[particle] = sumIm;
+    }
+}
+
+void BondOrder::accumulateHarmonics(unsigned int l, unsigned int n, Workspace& workspace, double* qRe, double* qIm)
+{
+    // Y_lm = N_lm P_l^m(cos theta) exp(i m phi). For a unit bond vector,
+    // sin^m(theta) exp(i m phi) = (x + iy)^m, so only a polynomial in z
+    // remains, which is computed by upward recurrence in l.
+
+    const double* x = &workspace.x[0];
+    const double* y = &workspace.y[0];
+    const double* z = &workspace.z[0];
+    double* re = &workspace.re[0];
+    double* im = &workspace.im[0];
+    double* p0 = &workspace.p0[0];
+    double* p1 = &workspace.p1[0];
+    double* p2 = &workspace.p2[0];
+
+    for (unsigned int i=0;i<n;i++)
+    {
+        re[i] = 1;
+        im[i] = 0;
+    }
+
+    // Coefficient of P_m^m, i.e. (-1)^m (2m-1)!!
+    double pmm = 1;
+
+    // Ratio of factorials (l-m)!/(l+m)!
+    double ratio = 1;
+
+    for (unsigned int m=0;m<=l;m++)
+    {
+        if (m > 0)
+        {
+            // Raise the azimuthal power.
+            for (unsigned int i=0;i<n;i++)
+            {
+                double tmp = re[i]*x[i] - im[i]*y[i];
+                im[i] = re[i]*y[i] + im[i]*x[i];
+                re[i] = tmp;
+            }
+
+            pmm *= -(2.0*m - 1);
+            ratio /= double(l + m)*(l - m + 1);
+        }
+
+        double norm = std::sqrt(((2*l + 1)/(4*M_PI))*ratio);
+
+        // Recurrence for the polynomial part of P_l^m(z).
+        double* p = p0;
+        for (unsigned int i=0;i<n;i++)
+            p0[i] = pmm;
+
+        if (l > m)
+        {
+            for (unsigned int i=0;i<n;i++)
+                p1[i] = z[i]*(2*m + 1)*pmm;
+
+            double* pa = p0;
+            double* pb = p1;
+            double* pc = p2;
+
+            for (unsigned int ll=m+2;ll<=l;ll++)
+            {
+                for (unsigned int i=0;i<n;i++)
+                    pc[i] = ((2.0*ll - 1)*z[i]*pb[i] - (ll + m - 1.0)*pa[i])/(ll - m);
+
+                double* tmp = pa;
+                pa = pb;
+                pb = pc;
+                pc = tmp;
+            }
+
+            p = pb;
+        }
+
+        double sumRe = 0;
+        double sumIm = 0;
+
+        for (unsigned int i=0;i<n;i++)
+        {
+            sumRe += p[i]*re[i];
+            sumIm += p[i]*im[i];
+        }
+
+        qRe[m] = norm*sumRe;
+        qIm[m] = norm*sumIm;
+    }
+}
+
+void BondOrder::reduce()
+{
+    if (dimension == 3)
+    {
+        double Q4Re[5] = {0}, Q4Im[5] = {0};
+        double Q6Re[7] = {0}, Q6Im[7] = {0};
+        unsigned long long nBonds = 0;
+
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            nBonds += nNeighbours[i];
+
+            double sum4 = 0;
+            double sum6 = 0;
+
+            // Negative m terms are related by symmetry, q_l-m = (-1)^m q_lm*
+            for (unsigned int m=0;m<5;m++)
+            {
+                double weight = (m == 0) ? 1 : 2;
+                sum4 += weight*(q4Re[5*i + m]*q4Re[5*i + m] + q4Im[5*i + m]*q4Im[5*i + m]);
+                Q4Re[m] += q4Re[5*i + m];
+                Q4Im[m] += q4Im[5*i + m];
+            }
+            for (unsigned int m=0;m<7;m++)
+            {
+                double weight = (m == 0) ? 1 : 2;
+                sum6 += weight*(q6Re[7*i + m]*q6Re[7*i + m] + q6Im[7*i + m]*q6Im[7*i + m]);
+                Q6Re[m] += q6Re[7*i + m];
+                Q6Im[m] += q6Im[7*i + m];
+            }
+
+            if (nNeighbours[i] > 0)
+            {
+                localQ4[i] = std::sqrt((4*M_PI/9)*sum4)/nNeighbours[i];
+                localQ6[i] = std::sqrt((4*M_PI/13)*sum6)/nNeighbours[i];
+            }
+            else
+            {
+                localQ4[i] = 0;
+                localQ6[i] = 0;
+            }
+        }
+
+        double sum4 = 0;
+        double sum6 = 0;
+
+        for (unsigned int m=0;m<5;m++)
+        {
+            double weight = (m == 0) ? 1 : 2;
+            sum4 += weight*(Q4Re[m]*Q4Re[m] + Q4Im[m]*Q4Im[m]);
+        }
+        for (unsigned int m=0;m<7;m++)
+        {
+            double weight = (m == 0) ? 1 : 2;
+            sum6 += weight*(Q6Re[m]*Q6Re[m] + Q6Im[m]*Q6Im[m]);
+        }
+
+        if (nBonds > 0)
+        {
+            Q4 = std::sqrt((4*M_PI/9)*sum4)/nBonds;
+            Q6 = std::sqrt((4*M_PI/13)*sum6)/nBonds;
+        }
+        else
+        {
+            Q4 = 0;
+            Q6 = 0;
+        }
+    }
+    else
+    {
+        double sumRe = 0;
+        double sumIm = 0;
+
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            if (nNeighbours[i] > 0)
+            {
+                double re = psi6Re[i]/nNeighbours[i];
+                double im = psi6Im[i]/nNeighbours[i];
+
+                localPsi6[i] = std::sqrt(re*re + im*im);
+                sumRe += re;
+                sumIm += im;
+            }
+            else localPsi6[i] = 0;
+        }
+
+        Psi6 = std::sqrt(sumRe*sumRe + sumIm*sumIm)/nParticles;
+    }
+}
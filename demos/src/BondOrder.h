@@ -0,0 +1,201 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _BONDORDER_H
+#define _BONDORDER_H
+
+#include <vector>
+
+/*! \file BondOrder.h
+    \brief Bond-orientational order parameters computed from model interactions.
+
+    In three dimensions the Steinhardt order parameters q4 and q6 are computed,
+    in two dimensions the hexatic order parameter psi6. The neighbours of each
+    particle are those returned by Model::computeInteractions.
+
+    Per-particle harmonics are cached. When run incrementally, the observe
+    method should be bound to the VMMC observer callback so that compute only
+    re-evaluates particles whose neighbourhood changed since the last call.
+    If compiled with OpenMP, the evaluation is parallelised over particles.
+*/
+
+// FORWARD DECLARATIONS
+
+class Model;
+
+//! Class for computing bond-orientational order parameters.
+class BondOrder
+{
+public:
+    //! Constructor.
+    /*! \param model_
+            A reference to the model object.
+
+        \param isIncremental_
+            Whether to only update particles flagged via observe.
+     */
+    BondOrder(Model&, bool isIncremental_ = false);
+
+    //! Observe the outcome of a trial move (bind to the VMMC observer callback).
+    /*! \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \param isAccepted
+            Whether the move was accepted.
+     */
+    void observe(unsigned int, const unsigned int*, bool);
+
+    //! Flag all particles for re-evaluation.
+    void invalidate();
+
+    //! Evaluate the order parameters.
+    void compute();
+
+    //! Get the global q4 order parameter (3D only).
+    /*! \return
+            The bond-averaged Steinhardt q4 order parameter.
+     */
+    double getQ4() const;
+
+    //! Get the global q6 order parameter (3D only).
+    /*! \return
+            The bond-averaged Steinhardt q6 order parameter.
+     */
+    double getQ6() const;
+
+    //! Get the global psi6 order parameter (2D only).
+    /*! \return
+            The magnitude of the particle-averaged hexatic order parameter.
+     */
+    double getPsi6() const;
+
+    //! Get the local q4 order parameters (3D only).
+    /*! \return
+            A const reference to the q4 value of each particle.
+     */
+    const std::vector<double>& getLocalQ4() const;
+
+    //! Get the local q6 order parameters (3D only).
+    /*! \return
+            A const reference to the q6 value of each particle.
+     */
+    const std::vector<double>& getLocalQ6() const;
+
+    //! Get the local psi6 order parameters (2D only).
+    /*! \return
+            A const reference to the magnitude of psi6 for each particle.
+     */
+    const std::vector<double>& getLocalPsi6() const;
+
+    //! Get the number of neighbours of each particle.
+    /*! \return
+            A const reference to the neighbour count of each particle.
+     */
+    const std::vector<unsigned int>& getNumNeighbours() const;
+
+private:
+    //! Per-thread workspace.
+    struct Workspace
+    {
+        std::vector<unsigned int> interactions;     //!< Interaction list.
+        std::vector<double> sep;                    //!< Separation vector.
+        std::vector<double> x;                      //!< Unit bond vector x components.
+        std::vector<double> y;                      //!< Unit bond vector y components.
+        std::vector<double> z;                      //!< Unit bond vector z components.
+        std::vector<double> re;                     //!< Real part of (x + iy)^m.
+        std::vector<double> im;                     //!< Imaginary part of (x + iy)^m.
+        std::vector<double> p0;                     //!< Legendre recurrence term.
+        std::vector<double> p1;                     //!< Legendre recurrence term.
+        std::vector<double> p2;                     //!< Legendre recurrence term.
+    };
+
+    Model& model;                                   //!< A reference to the model.
+    unsigned int nParticles;                        //!< The number of particles.
+    unsigned int dimension;                         //!< The dimension of the simulation box.
+    bool isIncremental;                             //!< Whether to update incrementally.
+
+    std::vector<std::vector<unsigned int> > neighbours;     //!< Neighbour list of each particle at the last evaluation.
+    std::vector<unsigned int> nNeighbours;          //!< Number of neighbours of each particle.
+    std::vector<double> q4Re;                       //!< Real part of the unnormalised q4m (m = 0..4) of each particle.
+    std::vector<double> q4Im;                       //!< Imaginary part of the unnormalised q4m (m = 0..4) of each particle.
+    std::vector<double> q6Re;                       //!< Real part of the unnormalised q6m (m = 0..6) of each particle.
+    std::vector<double> q6Im;                       //!< Imaginary part of the unnormalised q6m (m = 0..6) of each particle.
+    std::vector<double> psi6Re;                     //!< Real part of the unnormalised psi6 of each particle.
+    std::vector<double> psi6Im;                     //!< Imaginary part of the unnormalised psi6 of each particle.
+    std::vector<double> localQ4;                    //!< Local q4 of each particle.
+    std::vector<double> localQ6;                    //!< Local q6 of each particle.
+    std::vector<double> localPsi6;                  //!< Local |psi6| of each particle.
+    double Q4;                                      //!< Global q4.
+    double Q6;                                      //!< Global q6.
+    double Psi6;                                    //!< Global |psi6|.
+
+    std::vector<bool> isDirty;                      //!< Whether each particle is flagged for update.
+    std::vector<bool> isMoved;                      //!< Whether each particle has moved since the last evaluation.
+    std::vector<unsigned int> dirty;                //!< Particles flagged for update.
+    std::vector<unsigned int> moved;                //!< Particles that have moved since the last evaluation.
+    std::vector<Workspace> workspaces;              //!< Workspace for each thread.
+
+    //! Flag a particle for update.
+    /*! \param particle
+            The particle index.
+     */
+    void flag(unsigned int);
+
+    //! Evaluate the harmonics for a list of particles.
+    /*! \param list
+            The particle indices.
+
+        \param start
+            The position in the list at which to start.
+     */
+    void evaluate(const std::vector<unsigned int>&, unsigned int);
+
+    //! Evaluate the harmonics of a single particle.
+    /*! \param particle
+            The particle index.
+
+        \param workspace
+            The thread workspace.
+     */
+    void evaluate(unsigned int, Workspace&);
+
+    //! Accumulate spherical harmonics over bonds.
+    /*! \param l
+            The angular momentum number.
+
+        \param n
+            The number of bonds.
+
+        \param workspace
+            The thread workspace holding the unit bond vectors.
+
+        \param qRe
+            Array in which to store the real part of qlm (m = 0..l).
+
+        \param qIm
+            Array in which to store the imaginary part of qlm (m = 0..l).
+     */
+    void accumulateHarmonics(unsigned int, unsigned int, Workspace&, double*, double*);
+
+    //! Reduce the per-particle data to local and global order parameters.
+    void reduce();
+};
+
+#endif  /* _BONDORDER_H */
@@ -67,6 +67,23 @@ Box::Box(const std::vector<double>& boxSize_, const std::vector<bool>& isPeriodi
     }
 }
 
+void Box::setSize(const std::vector<double>& boxSize_)
+{
+    if (boxSize_.size() != dimension)
+    {
+        std::cerr << "[ERROR] Box: Box size has invalid dimensionality!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    boxSize = boxSize_;
+
+    for (unsigned int i=0;i<dimension;i++)
+    {
+        posMinImage[i] = 0.5*boxSize[i];
+        negMinImage[i] = -0.5*boxSize[i];
+    }
+}
+
 void Box::periodicBoundaries(std::vector<double>& coord)
 {
     for (unsigned int i=0;i<dimension;i++)
@@ -102,3 +119,32 @@ void Box::minimumImage(std::vector<double>& separation)
         }
     }
 }
+
+void Box::minimumImage(unsigned int axis, double* separations, unsigned int nSeparations) const
+{
+    double periodicLength = getPeriodicLength(axis);
+    double halfBox = 0.5*boxSize[axis];
+
+    for (unsigned int i=0;i<nSeparations;i++)
+        separations[i] += periodicLength*((separations[i] < -halfBox) - (separations[i] >= halfBox));
+}
+
+double Box::computeSeparation(const double* position1, const double* position2, double* separation) const
+{
+    double normSqd = 0;
+
+    for (unsigned int i=0;i<dimension;i++)
+    {
+        separation[i] = position2[i] - position1[i];
+        minimumImage(i, &separation[i], 1);
+
+        normSqd += separation[i]*separation[i];
+    }
+
+    return normSqd;
+}
+
+double Box::getPeriodicLength(unsigned int axis) const
+{
+    return isPeriodic[axis]*boxSize[axis];
+}
@@ -45,6 +45,12 @@ public:
      */
     Box(const std::vector<double>&, const std::vector<bool>&);
 
+    //! Set the size of the simulation box.
+    /*! \param boxSize_
+            Vector containing x,y,z size of box.
+     */
+    void setSize(const std::vector<double>&);
+
     //! Apply periodic boundary conditions.
     /* \param coord
             x,y,z coordinate vector.
@@ -57,6 +63,45 @@ public:
      */
     void minimumImage(std::vector<double>&);
 
+    //! Compute minimum image separations along an axis (without branching).
+    /*! The loop is free of branches, so it is vectorised when applied to a
+        block of separations.
+
+        \param axis
+            The axis index.
+
+        \param separations
+            An array of separations along the axis.
+
+        \param nSeparations
+            The number of separations.
+     */
+    void minimumImage(unsigned int, double*, unsigned int) const;
+
+    //! Compute the minimum image separation between two positions (without branching).
+    /*! \param position1
+            The position of the first particle.
+
+        \param position2
+            The position of the second particle.
+
+        \param separation
+            An array to store the separation vector from the first particle to the second.
+
+        \return
+            The squared norm of the separation.
+     */
+    double computeSeparation(const double*, const double*, double*) const;
+
+    //! Get the periodic length along an axis.
+    /*! \param axis
+            The axis index.
+
+        \return
+            The box size along the axis (zero if the boundary isn't periodic).
+     */
+    double getPeriodicLength(unsigned int) const;
+
     std::vector<double> boxSize;        //!< Size of the box in x,y,z directions.
     unsigned int dimension;             //!< Dimensionality of the simulation box.
 
@@ -30,9 +30,10 @@ CellList::CellList() : dimension(3)
 {
 }
 
-CellList::CellList(unsigned int dimension_, const std::vector<double>& boxSize, double range) : dimension(dimension_)
+CellList::CellList(unsigned int dimension_, const std::vector<double>& boxSize,
+    double range, double diameter) : dimension(dimension_)
 {
-    this->initialise(boxSize, range);
+    this->initialise(boxSize, range, diameter);
 }
 
 CellList& CellList::operator = (const CellList& cells)
@@ -63,7 +64,7 @@ CellList& CellList::operator = (const std::vector<Cell>& cells)
     return *this;
 }
 
-void CellList::initialise(const std::vector<double>& boxSize, double range)
+void CellList::initialise(const std::vector<double>& boxSize, double range, double diameter)
 {
     unsigned int i,j,k,m;
     unsigned int a,b,c;
@@ -72,16 +73,12 @@ void CellList::initialise(const std::vector<double>& boxSize, double range)
 
     cellsPerAxis.resize(dimension);
     cellSpacing.resize(dimension);
+    this->range = range;
+    this->diameter = diameter;
 
     for (i=0;i<dimension;i++)
     {
-        cellsPerAxis[i] = 1;
-
-        while ((boxSize[i] / (double) cellsPerAxis[i]) > range)
-        {
-            cellsPerAxis[i]++;
-        }
-        cellsPerAxis[i]--;
+        cellsPerAxis[i] = computeCellsPerAxis(boxSize[i]);
         cellSpacing[i] = boxSize[i] / (double) cellsPerAxis[i];
 
         // check that number of cells per axis is large enough
@@ -92,10 +89,11 @@ void CellList::initialise(const std::vector<double>& boxSize, double range)
         }
     }
 
-    // Estimate maximum number of particles per cell from interaction range.
-    // (Assumes particle diameter is one.)
-    if (dimension == 3) maxParticles = (cellSpacing[0]*cellSpacing[1]*cellSpacing[2]) / ((4.0/3.0)*M_PI*0.5*0.5*0.5);
-    else maxParticles = (cellSpacing[0]*cellSpacing[1]) / (M_PI*0.5*0.5);
+    // Estimate maximum number of particles per cell from interaction range
+    // and the diameter of the smallest particle.
+    double radius = 0.5*diameter;
+    if (dimension == 3) maxParticles = (cellSpacing[0]*cellSpacing[1]*cellSpacing[2]) / ((4.0/3.0)*M_PI*radius*radius*radius);
+    else maxParticles = (cellSpacing[0]*cellSpacing[1]) / (M_PI*radius*radius);
 
     // Add a buffer, e.g. if particles can overlap.
     maxParticles += 10;
@@ -204,6 +202,57 @@ void CellList::initialise(const std::vector<double>& boxSize, double range)
     }
 }
 
+bool CellList::isValidBox(const std::vector<double>& boxSize) const
+{
+    for (unsigned int i=0;i<dimension;i++)
+    {
+        if (computeCellsPerAxis(boxSize[i]) < 3) return false;
+    }
+
+    return true;
+}
+
+bool CellList::rescale(const std::vector<double>& boxSize, std::vector<Particle>& particles)
+{
+    bool isRebuild = false;
+
+    // Check whether the number of cells along any axis needs to change.
+    for (unsigned int i=0;i<dimension;i++)
+    {
+        double spacing = boxSize[i] / (double) cellsPerAxis[i];
+
+        if ((spacing <= range) || ((boxSize[i] / (double) (cellsPerAxis[i] + 1)) > range))
+        {
+            isRebuild = true;
+            break;
+        }
+    }
+
+    if (isRebuild)
+    {
+        // Store the particles held by the cell list.
+        std::vector<unsigned int> members;
+        for (unsigned int i=0;i<nCells;i++)
+        {
+            for (unsigned int j=0;j<at(i).tally;j++)
+                members.push_back(at(i).particles[j]);
+        }
+
+        initialise(boxSize, range, diameter);
+
+        for (unsigned int i=0;i<members.size();i++)
+            initCell(getCell(particles[members[i]]), particles[members[i]]);
+    }
+    else
+    {
+        // Scale the cell spacing, leaving the particle assignments intact.
+        for (unsigned int i=0;i<dimension;i++)
+            cellSpacing[i] = boxSize[i] / (double) cellsPerAxis[i];
+    }
+
+    return isRebuild;
+}
+
 void CellList::reset()
 {
     for (unsigned int i=0;i<nCells;i++) at(i).tally = 0;
@@ -279,3 +328,22 @@ unsigned int CellList::getNeighbours() const
 {
     return nNeighbours;
 }
+
+const std::vector<unsigned int>& CellList::getCellsPerAxis() const
+{
+    return cellsPerAxis;
+}
+
+const std::vector<double>& CellList::getCellSpacing() const
+{
+    return cellSpacing;
+}
+
+unsigned int CellList::computeCellsPerAxis(double length) const
+{
+    unsigned int n = 1;
+
+    while ((length / (double) n) > range) n++;
+
+    return n - 1;
+}
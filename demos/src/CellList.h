@@ -66,8 +66,11 @@ public:
 
         \param range
             Maximum interaction range.
+
+        \param diameter
+            The diameter of the smallest particle (used to estimate the cell occupancy).
      */
-    CellList(unsigned int, const std::vector<double>&, double);
+    CellList(unsigned int, const std::vector<double>&, double, double diameter = 1.0);
 
     //! Copy constructor. \param cells A reference to an existing CellList object.
     CellList& operator = (const CellList&);
@@ -81,8 +84,39 @@ public:
 
         \param range
             Maximum interaction range.
+
+        \param diameter
+            The diameter of the smallest particle (used to estimate the cell occupancy).
+     */
+    void initialise(const std::vector<double>&, double, double diameter = 1.0);
+
+    //! Check whether a box is large enough for the cell list.
+    /*! \param boxSize
+            The size of the simulation box in each dimension.
+
+        \return
+            Whether there are at least three cells along each axis.
+     */
+    bool isValidBox(const std::vector<double>&) const;
+
+    //! Rescale cell lists following a change in the box size.
+    /*! The cell spacing is scaled with the box. The cell list is only
+        rebuilt when the number of cells along an axis must change, i.e.
+        when the spacing falls below the interaction range, or when an
+        additional cell would fit.
+
+        \param boxSize
+            The new size of the simulation box in each dimension.
+
+        \param particles
+            Reference to a vector of particles (already in the rescaled box).
+            Only the particles currently held by the cell list are reinserted.
+            The box must be valid, see isValidBox.
+
+        \return
+            Whether the cell list was rebuilt.
      */
-    void initialise(const std::vector<double>&, double);
+    bool rescale(const std::vector<double>&, std::vector<Particle>&);
 
     //! Reset cell lists (zero cell tallys).
     void reset();
@@ -131,6 +165,12 @@ public:
     //! Get the number of neighbours per cell.
     unsigned int getNeighbours() const;
 
+    //! Get the number of cells along each axis.
+    const std::vector<unsigned int>& getCellsPerAxis() const;
+
+    //! Get the spacing between cells along each axis.
+    const std::vector<double>& getCellSpacing() const;
+
 private:
     unsigned int dimension;                     //!< Dimension of the simulation box.
     unsigned int nCells;                        //!< Total number of cells.
@@ -138,6 +178,17 @@ private:
     unsigned int maxParticles;                  //!< Maximum number of particles per cell.
     std::vector<unsigned int> cellsPerAxis;     //!< Number of cells per axis.
     std::vector<double> cellSpacing;            //!< Spacing between cells.
+    double range;                               //!< Maximum interaction range.
+    double diameter;                            //!< Diameter of the smallest particle.
+
+    //! Compute the number of cells along an axis.
+    /*! \param length
+            The length of the simulation box along the axis.
+
+        \return
+            The largest number of cells whose spacing exceeds the interaction range.
+     */
+    unsigned int computeCellsPerAxis(double) const;
 };
 
 #endif  /* _CELLLIST_H */
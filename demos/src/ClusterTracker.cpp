@@ -0,0 +1,451 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "ClusterTracker.h"
+#include "Model.h"
+#include "Particle.h"
+
+ClusterTracker::ClusterTracker(Model& model_) :
+    model(model_),
+    energy(0),
+    stamp(0)
+{
+    initialise();
+}
+
+void ClusterTracker::initialise()
+{
+    nParticles = model.particles.size();
+
+    // Allocate memory.
+    bonds.resize(nParticles);
+    bondEnergies.resize(nParticles);
+    labels.assign(nParticles, nParticles);
+    posCluster.resize(nParticles);
+    members.resize(nParticles);
+    histogram.assign(nParticles + 1, 0);
+    interactions.resize(model.getMaxInteractions());
+    visited.assign(nParticles, 0);
+    freeLabels.clear();
+
+    nClusters = 0;
+    largestClusterSize = 0;
+    energy = 0;
+    stamp = 0;
+
+    // Compute the bonds for each particle.
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        computeBonds(i, bonds[i], bondEnergies[i]);
+        members[i].clear();
+
+        // Each bond is counted twice.
+        for (unsigned int j=0;j<bondEnergies[i].size();j++)
+            energy += 0.5*bondEnergies[i][j];
+    }
+
+    unsigned int label = 0;
+
+    // Label the connected components with a breadth-first search.
+    for (unsigned int i=0;i<nParticles;i++)
+    {
+        if (labels[i] == nParticles)
+        {
+            labels[i] = label;
+            posCluster[i] = 0;
+            members[label].push_back(i);
+
+            for (unsigned int j=0;j<members[label].size();j++)
+            {
+                unsigned int particle = members[label][j];
+
+                for (unsigned int k=0;k<bonds[particle].size();k++)
+                {
+                    unsigned int neighbour = bonds[particle][k];
+
+                    if (labels[neighbour] == nParticles)
+                    {
+                        labels[neighbour] = label;
+                        posCluster[neighbour] = members[label].size();
+                        members[label].push_back(neighbour);
+                    }
+                }
+            }
+
+            updateHistogram(0, members[label].size());
+            nClusters++;
+            label++;
+        }
+    }
+
+    // Store the unused labels.
+    for (unsigned int i=nParticles;i>label;i--)
+        freeLabels.push_back(i-1);
+}
+
+void ClusterTracker::update(unsigned int nMoved, const unsigned int* moved)
+{
+    formed.clear();
+    broken.clear();
+
+    // Recompute the bonds of the moved particles.
+    for (unsigned int i=0;i<nMoved;i++)
+    {
+        unsigned int particle = moved[i];
+
+        computeBonds(particle, newBonds, newBondEnergies);
+
+        const std::vector<unsigned int>& oldBonds = bonds[particle];
+        const std::vector<double>& oldBondEnergies = bondEnergies[particle];
+
+        // Merge the sorted lists to find the bonds that were broken or formed.
+        unsigned int j = 0, k = 0;
+        while ((j < oldBonds.size()) || (k < newBonds.size()))
+        {
+            if ((k == newBonds.size()) || ((j < oldBonds.size()) && (oldBonds[j] < newBonds[k])))
+            {
+                // Bond broken.
+                std::vector<unsigned int>& list = bonds[oldBonds[j]];
+                unsigned int pos = findBond(list, particle);
+                if (pos < list.size())
+                {
+                    list.erase(list.begin() + pos);
+                    bondEnergies[oldBonds[j]].erase(bondEnergies[oldBonds[j]].begin() + pos);
+                }
+                broken.push_back(std::make_pair(particle, oldBonds[j]));
+                energy -= oldBondEnergies[j];
+                j++;
+            }
+            else if ((j == oldBonds.size()) || (newBonds[k] < oldBonds[j]))
+            {
+                // Bond formed.
+                std::vector<unsigned int>& list = bonds[newBonds[k]];
+                unsigned int pos = std::lower_bound(list.begin(), list.end(), particle) - list.begin();
+                list.insert(list.begin() + pos, particle);
+                bondEnergies[newBonds[k]].insert(bondEnergies[newBonds[k]].begin() + pos, newBondEnergies[k]);
+                formed.push_back(std::make_pair(particle, newBonds[k]));
+                energy += newBondEnergies[k];
+                k++;
+            }
+            else
+            {
+                // Bond persists, but its energy may have changed.
+                unsigned int pos = findBond(bonds[newBonds[k]], particle);
+                if (pos < bonds[newBonds[k]].size()) bondEnergies[newBonds[k]][pos] = newBondEnergies[k];
+                energy += newBondEnergies[k] - oldBondEnergies[j];
+                j++;
+                k++;
+            }
+        }
+
+        bonds[particle].swap(newBonds);
+        bondEnergies[particle].swap(newBondEnergies);
+    }
+
+    // Merge clusters joined by new bonds.
+    for (unsigned int i=0;i<formed.size();i++)
+        merge(formed[i].first, formed[i].second);
+
+    // Collect the ends of broken bonds that still share a cluster label.
+    endPoints.clear();
+    for (unsigned int i=0;i<broken.size();i++)
+    {
+        unsigned int particle1 = broken[i].first;
+        unsigned int particle2 = broken[i].second;
+
+        if (labels[particle1] == labels[particle2])
+        {
+            endPoints.push_back(std::make_pair(labels[particle1], particle1));
+            endPoints.push_back(std::make_pair(labels[particle2], particle2));
+        }
+    }
+
+    // Group end points by cluster label.
+    std::sort(endPoints.begin(), endPoints.end());
+    endPoints.erase(std::unique(endPoints.begin(), endPoints.end()), endPoints.end());
+
+    // Check that all end points within each cluster remain connected.
+    // Every fragment of a broken cluster contains at least one end point,
+    // so testing each end point against a common root is sufficient.
+    unsigned int i = 0;
+    while (i < endPoints.size())
+    {
+        unsigned int label = endPoints[i].first;
+        unsigned int root = endPoints[i].second;
+
+        i++;
+        while ((i < endPoints.size()) && (endPoints[i].first == label))
+        {
+            unsigned int particle = endPoints[i].second;
+
+            // Only test end points that haven't been split off already.
+            if (labels[particle] == label)
+            {
+                // The root fragment was relabelled, use the current end point instead.
+                if (!split(root, particle) && (labels[root] != label))
+                    root = particle;
+            }
+
+            i++;
+        }
+    }
+}
+
+void ClusterTracker::observe(unsigned int nMoving, const unsigned int* moveList, bool isAccepted)
+{
+    if (isAccepted) update(nMoving, moveList);
+}
+
+unsigned int ClusterTracker::getNumParticles() const
+{
+    return nParticles;
+}
+
+unsigned int ClusterTracker::getNumClusters() const
+{
+    return nClusters;
+}
+
+unsigned int ClusterTracker::getLargestClusterSize() const
+{
+    return largestClusterSize;
+}
+
+const std::vector<unsigned int>& ClusterTracker::getSizeHistogram() const
+{
+    return histogram;
+}
+
+unsigned int ClusterTracker::getCluster(unsigned int particle) const
+{
+    return labels[particle];
+}
+
+unsigned int ClusterTracker::getClusterSize(unsigned int particle) const
+{
+    return members[labels[particle]].size();
+}
+
+const std::vector<unsigned int>& ClusterTracker::getBonds(unsigned int particle) const
+{
+    return bonds[particle];
+}
+
+double ClusterTracker::getEnergy() const
+{
+    return energy;
+}
+
+void ClusterTracker::computeBonds(unsigned int particle,
+    std::vector<unsigned int>& list, std::vector<double>& energies)
+{
+    const Particle& p = model.particles[particle];
+
+#ifndef ISOTROPIC
+    unsigned int nInteractions = model.computeInteractions(particle,
+        &p.position[0], &p.orientation[0], &interactions[0]);
+#else
+    unsigned int nInteractions = model.computeInteractions(particle,
+        &p.position[0], &interactions[0]);
+#endif
+
+    // Compute the pair energy of each bond.
+    sorted.resize(nInteractions);
+    for (unsigned int i=0;i<nInteractions;i++)
+    {
+        const Particle& neighbour = model.particles[interactions[i]];
+
+        sorted[i].first = interactions[i];
+#ifndef ISOTROPIC
+        sorted[i].second = model.computePairEnergy(particle, &p.position[0], &p.orientation[0],
+            interactions[i], &neighbour.position[0], &neighbour.orientation[0]);
+#else
+        sorted[i].second = model.computePairEnergy(particle, &p.position[0],
+            interactions[i], &neighbour.position[0]);
+#endif
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    list.resize(nInteractions);
+    energies.resize(nInteractions);
+    for (unsigned int i=0;i<nInteractions;i++)
+    {
+        list[i] = sorted[i].first;
+        energies[i] = sorted[i].second;
+    }
+}
+
+unsigned int ClusterTracker::findBond(const std::vector<unsigned int>& list, unsigned int particle) const
+{
+    std::vector<unsigned int>::const_iterator iter = std::lower_bound(list.begin(), list.end(), particle);
+    if ((iter != list.end()) && (*iter == particle)) return iter - list.begin();
+    else return list.size();
+}
+
+void ClusterTracker::merge(unsigned int particle1, unsigned int particle2)
+{
+    unsigned int label1 = labels[particle1];
+    unsigned int label2 = labels[particle2];
+
+    // Particles are already in the same cluster.
+    if (label1 == label2) return;
+
+    // Relabel the smaller cluster.
+    if (members[label1].size() < members[label2].size()) std::swap(label1, label2);
+
+    unsigned int size1 = members[label1].size();
+    unsigned int size2 = members[label2].size();
+
+    for (unsigned int i=0;i<size2;i++)
+    {
+        unsigned int particle = members[label2][i];
+        labels[particle] = label1;
+        posCluster[particle] = members[label1].size();
+        members[label1].push_back(particle);
+    }
+
+    members[label2].clear();
+    freeLabels.push_back(label2);
+
+    updateHistogram(size2, 0);
+    updateHistogram(size1, size1 + size2);
+    nClusters--;
+}
+
+bool ClusterTracker::split(unsigned int particle1, unsigned int particle2)
+{
+    advanceStamp();
+    unsigned int stampA = stamp;
+    advanceStamp();
+    unsigned int stampB = stamp;
+
+    queueA.clear();
+    queueB.clear();
+
+    queueA.push_back(particle1);
+    queueB.push_back(particle2);
+    visited[particle1] = stampA;
+    visited[particle2] = stampB;
+
+    unsigned int headA = 0, headB = 0;
+
+    // Advance the two searches in lock step, one particle at a time.
+    while (true)
+    {
+        // First search exhausted its fragment.
+        if (headA == queueA.size())
+        {
+            relabel(queueA);
+            return false;
+        }
+
+        unsigned int particle = queueA[headA++];
+        for (unsigned int i=0;i<bonds[particle].size();i++)
+        {
+            unsigned int neighbour = bonds[particle][i];
+
+            // The searches have met.
+            if (visited[neighbour] == stampB) return true;
+
+            if (visited[neighbour] != stampA)
+            {
+                visited[neighbour] = stampA;
+                queueA.push_back(neighbour);
+            }
+        }
+
+        // Second search exhausted its fragment.
+        if (headB == queueB.size())
+        {
+            relabel(queueB);
+            return false;
+        }
+
+        particle = queueB[headB++];
+        for (unsigned int i=0;i<bonds[particle].size();i++)
+        {
+            unsigned int neighbour = bonds[particle][i];
+
+            // The searches have met.
+            if (visited[neighbour] == stampA) return true;
+
+            if (visited[neighbour] != stampB)
+            {
+                visited[neighbour] = stampB;
+                queueB.push_back(neighbour);
+            }
+        }
+    }
+}
+
+void ClusterTracker::relabel(const std::vector<unsigned int>& fragment)
+{
+    unsigned int oldLabel = labels[fragment[0]];
+    unsigned int oldSize = members[oldLabel].size();
+
+    unsigned int newLabel = freeLabels.back();
+    freeLabels.pop_back();
+
+    for (unsigned int i=0;i<fragment.size();i++)
+    {
+        unsigned int particle = fragment[i];
+
+        // Remove from the old cluster.
+        unsigned int last = members[oldLabel].back();
+        members[oldLabel][posCluster[particle]] = last;
+        posCluster[last] = posCluster[particle];
+        members[oldLabel].pop_back();
+
+        // Add to the new cluster.
+        labels[particle] = newLabel;
+        posCluster[particle] = members[newLabel].size();
+        members[newLabel].push_back(particle);
+    }
+
+    updateHistogram(oldSize, oldSize - fragment.size());
+    updateHistogram(0, fragment.size());
+    nClusters++;
+}
+
+void ClusterTracker::advanceStamp()
+{
+    if (stamp == std::numeric_limits<unsigned int>::max())
+    {
+        std::fill(visited.begin(), visited.end(), 0);
+        stamp = 0;
+    }
+
+    stamp++;
+}
+
+void ClusterTracker::updateHistogram(unsigned int oldSize, unsigned int newSize)
+{
+    if (oldSize > 0) histogram[oldSize]--;
+
+    if (newSize > 0)
+    {
+        histogram[newSize]++;
+        if (newSize > largestClusterSize) largestClusterSize = newSize;
+    }
+
+    // The largest cluster may have shrunk.
+    while ((largestClusterSize > 0) && (histogram[largestClusterSize] == 0))
+        largestClusterSize--;
+}
@@ -0,0 +1,232 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CLUSTERTRACKER_H
+#define _CLUSTERTRACKER_H
+
+#include <utility>
+#include <vector>
+
+/*! \file ClusterTracker.h
+    \brief An incrementally updated tracker for the connected components
+    (clusters) of the interaction graph.
+
+    The tracker stores a sorted bond list for every particle. Following a
+    move, only the bonds of the particles that moved are recomputed. Newly
+    formed bonds merge clusters by relabelling the smaller of the two, while
+    broken bonds trigger a pair of interleaved breadth-first searches from
+    the bond ends. The first search to exhaust its component is relabelled,
+    so the cost of a split is proportional to the size of the smaller
+    fragment rather than the size of the original cluster.
+
+    The interaction graph is assumed to be symmetric, i.e. if particle i
+    interacts with particle j, then j interacts with i.
+
+    The pair energy of each bond is stored alongside the bond list, so the
+    total interaction energy is also updated incrementally, at the cost of
+    one pair energy evaluation per bond of each moved particle.
+*/
+
+// FORWARD DECLARATIONS
+
+class Model;
+
+//! Class for tracking clusters of interacting particles.
+class ClusterTracker
+{
+public:
+    //! Constructor.
+    /*! \param model_
+            A reference to the model object.
+     */
+    ClusterTracker(Model&);
+
+    //! Build the bond network and cluster labels from scratch.
+    void initialise();
+
+    //! Update the clusters following a move.
+    /*! \param nMoved
+            The number of particles that moved.
+
+        \param moved
+            The indices of the particles that moved.
+     */
+    void update(unsigned int, const unsigned int*);
+
+    //! Observe the outcome of a trial move (bind to the VMMC observer callback).
+    /*! \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \param isAccepted
+            Whether the move was accepted.
+     */
+    void observe(unsigned int, const unsigned int*, bool);
+
+    //! Get the number of particles.
+    /*! \return
+            The number of particles.
+     */
+    unsigned int getNumParticles() const;
+
+    //! Get the number of clusters.
+    /*! \return
+            The number of clusters (including monomers).
+     */
+    unsigned int getNumClusters() const;
+
+    //! Get the size of the largest cluster.
+    /*! \return
+            The number of particles in the largest cluster.
+     */
+    unsigned int getLargestClusterSize() const;
+
+    //! Get the cluster size histogram.
+    /*! \return
+            A const reference to the histogram, indexed by cluster size.
+     */
+    const std::vector<unsigned int>& getSizeHistogram() const;
+
+    //! Get the label of the cluster containing a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            The cluster label.
+     */
+    unsigned int getCluster(unsigned int) const;
+
+    //! Get the size of the cluster containing a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            The number of particles in the cluster.
+     */
+    unsigned int getClusterSize(unsigned int) const;
+
+    //! Get the bonds of a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            A const reference to the sorted list of bonded neighbours.
+     */
+    const std::vector<unsigned int>& getBonds(unsigned int) const;
+
+    //! Get the total energy of the bond network.
+    /*! \return
+            The sum of the pair energies of all bonded particles (in units of kBT).
+     */
+    double getEnergy() const;
+
+private:
+    Model& model;                                           //!< A reference to the model.
+    unsigned int nParticles;                                //!< The number of particles.
+    unsigned int nClusters;                                 //!< The number of clusters.
+    unsigned int largestClusterSize;                        //!< The size of the largest cluster.
+    double energy;                                          //!< The total energy of the bond network.
+
+    std::vector<std::vector<unsigned int> > bonds;          //!< Sorted bond list for each particle.
+    std::vector<std::vector<double> > bondEnergies;         //!< Pair energy of each bond.
+    std::vector<unsigned int> labels;                       //!< Cluster label for each particle.
+    std::vector<unsigned int> posCluster;                   //!< Position of each particle in its cluster's member list.
+    std::vector<std::vector<unsigned int> > members;        //!< Member list for each cluster label.
+    std::vector<unsigned int> freeLabels;                   //!< Stack of unused cluster labels.
+    std::vector<unsigned int> histogram;                    //!< Number of clusters of each size.
+
+    std::vector<unsigned int> interactions;                 //!< Workspace for interaction lists.
+    std::vector<unsigned int> newBonds;                     //!< Workspace for updated bond lists.
+    std::vector<double> newBondEnergies;                    //!< Workspace for updated bond energies.
+    std::vector<std::pair<unsigned int, double> > sorted;   //!< Workspace for sorting bonds.
+    std::vector<std::pair<unsigned int, unsigned int> > formed;     //!< Bonds formed during the update.
+    std::vector<std::pair<unsigned int, unsigned int> > broken;     //!< Bonds broken during the update.
+    std::vector<std::pair<unsigned int, unsigned int> > endPoints;  //!< (label, particle) pairs for broken bonds.
+
+    std::vector<unsigned int> visited;                      //!< Search stamps for each particle.
+    unsigned int stamp;                                     //!< The current search stamp.
+    std::vector<unsigned int> queueA;                       //!< Breadth-first search queue.
+    std::vector<unsigned int> queueB;                       //!< Breadth-first search queue.
+
+    //! Compute the sorted interaction list of a particle.
+    /*! \param particle
+            The particle index.
+
+        \param list
+            The vector in which to store the list.
+
+        \param energies
+            The vector in which to store the pair energy of each bond.
+     */
+    void computeBonds(unsigned int, std::vector<unsigned int>&, std::vector<double>&);
+
+    //! Find the position of a particle in a bond list.
+    /*! \param list
+            The sorted bond list.
+
+        \param particle
+            The particle index.
+
+        \return
+            The position of the particle in the list.
+     */
+    unsigned int findBond(const std::vector<unsigned int>&, unsigned int) const;
+
+    //! Merge the clusters containing two particles.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param particle2
+            The index of the second particle.
+     */
+    void merge(unsigned int, unsigned int);
+
+    //! Check whether two particles in the same cluster are still connected and split the cluster if not.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param particle2
+            The index of the second particle.
+
+        \return
+            Whether the particles remain connected. If not, the smaller of the
+            two fragments is moved to a new cluster.
+     */
+    bool split(unsigned int, unsigned int);
+
+    //! Move a list of particles into a new cluster.
+    /*! \param fragment
+            The indices of the particles to relabel.
+     */
+    void relabel(const std::vector<unsigned int>&);
+
+    //! Advance the search stamp, clearing the stamps on overflow.
+    void advanceStamp();
+
+    //! Update the histogram following a change in a cluster's size.
+    /*! \param oldSize
+            The previous size of the cluster (zero for a new cluster).
+
+        \param newSize
+            The new size of the cluster (zero for a deleted cluster).
+     */
+    void updateHistogram(unsigned int, unsigned int);
+};
+
+#endif  /* _CLUSTERTRACKER_H */
@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Box.h"
+#include "CellList.h"
+#include "CoordinationWellium.h"
+#include "Particle.h"
+
+CoordinationWellium::CoordinationWellium(
+    Box& box_,
+    std::vector<Particle>& particles_,
+    CellList& cells_,
+    unsigned int maxInteractions_,
+    double interactionEnergy_,
+    double interactionRange_,
+    double coordinationEnergy_,
+    unsigned int valence_) :
+    SquareWellium(box_, particles_, cells_, maxInteractions_, interactionEnergy_, interactionRange_),
+    coordinationEnergy(coordinationEnergy_),
+    valence(valence_),
+    manyBodyEnergy(0),
+    trialEnergyChange(0)
+{
+    coordinations.resize(particles.size());
+    terms.resize(particles.size());
+    trialParticles.reserve(particles.size());
+    trialCoordinations.reserve(particles.size());
+}
+
+void CoordinationWellium::initialiseCoordinations()
+{
+    manyBodyEnergy = 0;
+
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        coordinations[i] = computeCoordination(i);
+        terms[i] = computeTerm(coordinations[i]);
+        manyBodyEnergy += terms[i];
+    }
+
+    trialParticles.clear();
+    trialCoordinations.clear();
+}
+
+double CoordinationWellium::computeManyBodyEnergy(unsigned int nAffected, const unsigned int* affected)
+{
+    trialParticles.clear();
+    trialCoordinations.clear();
+    trialEnergyChange = 0;
+
+    // The model is already in the trial configuration, so recompute the
+    // affected terms and compare them to the cache.
+    for (unsigned int i=0;i<nAffected;i++)
+    {
+        unsigned int coordination = computeCoordination(affected[i]);
+
+        if (coordination != coordinations[affected[i]])
+        {
+            trialParticles.push_back(affected[i]);
+            trialCoordinations.push_back(coordination);
+            trialEnergyChange += computeTerm(coordination) - terms[affected[i]];
+        }
+    }
+
+    return trialEnergyChange;
+}
+
+void CoordinationWellium::observe(unsigned int nMoving, const unsigned int* moveList, bool isAccepted)
+{
+    // Commit the trial terms.
+    if (isAccepted)
+    {
+        for (unsigned int i=0;i<trialParticles.size();i++)
+        {
+            coordinations[trialParticles[i]] = trialCoordinations[i];
+            terms[trialParticles[i]] = computeTerm(trialCoordinations[i]);
+        }
+
+        manyBodyEnergy += trialEnergyChange;
+    }
+
+    trialParticles.clear();
+    trialCoordinations.clear();
+    trialEnergyChange = 0;
+}
+
+unsigned int CoordinationWellium::getCoordination(unsigned int particle) const
+{
+    return coordinations[particle];
+}
+
+double CoordinationWellium::getManyBodyEnergy() const
+{
+    return manyBodyEnergy/particles.size();
+}
+
+unsigned int CoordinationWellium::computeCoordination(unsigned int particle) const
+{
+    unsigned int coordination = 0;
+
+    const double* position = &particles[particle].position[0];
+
+    // Check all neighbouring cells including same cell.
+    for (unsigned int i=0;i<cells.getNeighbours();i++)
+    {
+        // Cell index.
+        unsigned int cell = cells[particles[particle].cell].neighbours[i];
+
+        // Check all particles within cell.
+        for (unsigned int j=0;j<cells[cell].tally;j++)
+        {
+            // Index of neighbouring particle.
+            unsigned int neighbour = cells[cell].particles[j];
+
+            double sep[3];
+            double normSqd = box.computeSeparation(position, &particles[neighbour].position[0], sep);
+
+            coordination += ((neighbour != particle) && (normSqd < squaredCutOffDistance));
+        }
+    }
+
+    return coordination;
+}
+
+double CoordinationWellium::computeTerm(unsigned int coordination) const
+{
+    if (coordination <= valence) return 0;
+
+    double excess = coordination - valence;
+    return coordinationEnergy*excess*excess;
+}
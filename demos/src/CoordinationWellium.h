@@ -0,0 +1,149 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _COORDINATIONWELLIUM_H
+#define _COORDINATIONWELLIUM_H
+
+#include "SquareWellium.h"
+
+/*! \file CoordinationWellium.h
+    \brief A square-well potential with a many-body coordination penalty.
+
+    On top of the square-well pair interaction, each particle i feels a
+    local many-body energy of coordinationEnergy*(n_i - valence)^2 when its
+    coordination number, n_i, i.e. the number of particles within the
+    interaction range, exceeds the valence. Since particles can't bind
+    more than a few neighbours without paying a penalty, the model forms
+    low-density networks rather than compact droplets.
+
+    The coordination number and local term of each particle are cached. When
+    the VMMC many-body callback is triggered, only the terms of the affected
+    particles (the moving cluster plus its neighbours before and after the
+    move) are recomputed, and the change relative to the cache is returned.
+    The recomputed terms are committed to the cache when the observer callback
+    reports that the move was accepted.
+
+    Since the model stores per-particle state, the callbacks must be bound to
+    a pointer to the model, rather than to a copy of it. Call
+    initialiseCoordinations once the particle configuration has been set.
+*/
+
+//! Class defining a square-well potential with a coordination penalty.
+class CoordinationWellium : public SquareWellium
+{
+public:
+    //! Constructor.
+    /*! \param box_
+            A reference to the simulation box object.
+
+        \param particles_
+            A reference to the particle list.
+
+        \param cells_
+            A reference to the cell list object.
+
+        \param maxInteractions_
+            The maximum number of interactions per particle.
+
+        \param interactionEnergy_
+            The square well interaction energy (in units of kBT).
+
+        \param interactionRange_
+            The square well interaction range (in units of the particle diameter).
+
+        \param coordinationEnergy_
+            The energy scale of the coordination penalty (in units of kBT).
+
+        \param valence_
+            The largest coordination number without a penalty.
+     */
+    CoordinationWellium(Box&, std::vector<Particle>&, CellList&, unsigned int, double, double, double, unsigned int);
+
+    //! Compute the coordination number and many-body energy of every particle.
+    void initialiseCoordinations();
+
+    //! Calculate the change in the many-body energy following a trial move.
+    /*! \param nAffected
+            The number of affected particles.
+
+        \param affected
+            The indices of the affected particles.
+
+        \return
+            The change in the many-body energy.
+     */
+    double computeManyBodyEnergy(unsigned int, const unsigned int*);
+
+    //! Observe the outcome of a trial move (bind to the VMMC observer callback).
+    /*! \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \param isAccepted
+            Whether the move was accepted.
+     */
+    void observe(unsigned int, const unsigned int*, bool);
+
+    //! Get the coordination number of a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            The number of particles within the interaction range.
+     */
+    unsigned int getCoordination(unsigned int) const;
+
+    //! Get the many-body energy per particle.
+    /*! \return
+            The many-body energy per particle.
+     */
+    double getManyBodyEnergy() const;
+
+private:
+    double coordinationEnergy;                      //!< The energy scale of the coordination penalty.
+    unsigned int valence;                           //!< The largest coordination number without a penalty.
+    double manyBodyEnergy;                          //!< The total many-body energy.
+
+    std::vector<unsigned int> coordinations;        //!< The cached coordination number of each particle.
+    std::vector<double> terms;                      //!< The cached many-body energy of each particle.
+
+    std::vector<unsigned int> trialParticles;       //!< The particles recomputed for the trial move.
+    std::vector<unsigned int> trialCoordinations;   //!< The coordination numbers following the trial move.
+    double trialEnergyChange;                       //!< The change in the many-body energy for the trial move.
+
+    //! Count the particles within the interaction range of a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            The coordination number.
+     */
+    unsigned int computeCoordination(unsigned int) const;
+
+    //! Calculate the many-body energy for a given coordination number.
+    /*! \param coordination
+            The coordination number.
+
+        \return
+            The many-body energy.
+     */
+    double computeTerm(unsigned int) const;
+};
+
+#endif  /* _COORDINATIONWELLIUM_H */
@@ -0,0 +1,193 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "Correlator.h"
+
+Correlator::Correlator(double sampleInterval_, unsigned int blockLength_,
+    unsigned int averagingLength_, unsigned int nLevels_) :
+    sampleInterval(sampleInterval_),
+    blockLength(blockLength_),
+    averagingLength(averagingLength_),
+    nLevels(nLevels_)
+{
+    // Check parameters.
+    if (averagingLength < 2)
+    {
+        std::cerr << "[ERROR] Correlator: Averaging length must be at least two!\n";
+        exit(EXIT_FAILURE);
+    }
+    if ((blockLength < averagingLength) || (blockLength % averagingLength != 0))
+    {
+        std::cerr << "[ERROR] Correlator: Block length must be a multiple of the averaging length!\n";
+        exit(EXIT_FAILURE);
+    }
+    if (nLevels == 0)
+    {
+        std::cerr << "[ERROR] Correlator: Number of levels must be positive!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    minLag = blockLength/averagingLength;
+
+    // Allocate memory.
+    shifts.resize(nLevels);
+    sums.resize(nLevels);
+    counts.resize(nLevels);
+    for (unsigned int i=0;i<nLevels;i++)
+    {
+        shifts[i].resize(blockLength);
+        sums[i].resize(blockLength);
+        counts[i].resize(blockLength);
+    }
+    heads.resize(nLevels);
+    nStored.resize(nLevels);
+    accumulators.resize(nLevels);
+    nAccumulated.resize(nLevels);
+
+    reset();
+}
+
+void Correlator::sample(double value)
+{
+    nSamples++;
+    sum += value;
+
+    push(0, value);
+}
+
+void Correlator::reset()
+{
+    nSamples = 0;
+    sum = 0;
+    maxLevel = 0;
+
+    for (unsigned int i=0;i<nLevels;i++)
+    {
+        std::fill(sums[i].begin(), sums[i].end(), 0);
+        std::fill(counts[i].begin(), counts[i].end(), 0);
+        heads[i] = 0;
+        nStored[i] = 0;
+        accumulators[i] = 0;
+        nAccumulated[i] = 0;
+    }
+}
+
+unsigned long long Correlator::getNumSamples() const
+{
+    return nSamples;
+}
+
+double Correlator::getMean() const
+{
+    if (nSamples == 0) return 0;
+    return sum/nSamples;
+}
+
+void Correlator::getCorrelation(std::vector<double>& lags, std::vector<double>& correlation,
+    bool isConnected, bool isNormalised) const
+{
+    lags.clear();
+    correlation.clear();
+
+    double mean = getMean();
+    double offset = isConnected ? mean*mean : 0;
+    double scale = 1;
+
+    // Normalise by the connected correlation at zero lag.
+    if (isNormalised && (counts[0][0] > 0))
+    {
+        scale = sums[0][0]/counts[0][0] - mean*mean;
+        if (scale == 0) scale = 1;
+        offset = mean*mean;
+    }
+
+    double stride = 1;
+    for (unsigned int i=0;i<=maxLevel;i++)
+    {
+        for (unsigned int j=((i == 0) ? 0 : minLag);j<blockLength;j++)
+        {
+            if (counts[i][j] > 0)
+            {
+                lags.push_back(j*stride*sampleInterval);
+                correlation.push_back((sums[i][j]/counts[i][j] - offset)/scale);
+            }
+        }
+
+        stride *= averagingLength;
+    }
+}
+
+void Correlator::save(std::string fileName, bool isNormalised) const
+{
+    std::vector<double> lags, correlation;
+    getCorrelation(lags, correlation, true, isNormalised);
+
+    // Create file pointer.
+    FILE *pFile = fopen(fileName.c_str(), "w");
+
+    if (pFile == NULL)
+    {
+        std::cerr << "[ERROR] Correlator: Unable to open file " << fileName << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int i=0;i<lags.size();i++)
+        fprintf(pFile, "%.8e %.8e\n", lags[i], correlation[i]);
+
+    // Close file pointer.
+    fclose(pFile);
+}
+
+void Correlator::push(unsigned int level, double value)
+{
+    if (level == nLevels) return;
+    if (level > maxLevel) maxLevel = level;
+
+    std::vector<double>& shift = shifts[level];
+
+    // Store the value.
+    unsigned int head = heads[level];
+    shift[head] = value;
+    if (nStored[level] < blockLength) nStored[level]++;
+
+    // Average values into the next level.
+    accumulators[level] += value;
+    nAccumulated[level]++;
+    if (nAccumulated[level] == averagingLength)
+    {
+        push(level + 1, accumulators[level]/averagingLength);
+        accumulators[level] = 0;
+        nAccumulated[level] = 0;
+    }
+
+    // Lags below minLag are resolved by the level beneath.
+    unsigned int start = (level == 0) ? 0 : minLag;
+
+    for (unsigned int i=start;i<nStored[level];i++)
+    {
+        unsigned int index = (head + blockLength - i) % blockLength;
+        sums[level][i] += value*shift[index];
+        counts[level][i]++;
+    }
+
+    heads[level] = (head + 1) % blockLength;
+}
@@ -0,0 +1,130 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CORRELATOR_H
+#define _CORRELATOR_H
+
+#include <string>
+#include <vector>
+
+/*! \file Correlator.h
+    \brief An online multi-tau time-correlation function accumulator.
+
+    Implements the multiple-tau correlator described by Ramirez et al.,
+    J. Chem. Phys. 133, 154103 (2010). Samples are stored in a hierarchy of
+    shift registers, each holding blockLength values. Every averagingLength
+    values entering a level are averaged and passed to the next level, so
+    level k resolves lag times of order averagingLength^k samples. Memory is
+    logarithmic in the longest lag time and the amortised cost per sample is
+    O(blockLength).
+*/
+
+//! Class for accumulating the autocorrelation function of a scalar observable.
+class Correlator
+{
+public:
+    //! Constructor.
+    /*! \param sampleInterval
+            The time between samples (e.g. in Monte Carlo sweeps).
+
+        \param blockLength
+            The number of values stored at each level.
+
+        \param averagingLength
+            The number of values averaged when passing to the next level.
+
+        \param nLevels
+            The number of levels.
+     */
+    Correlator(double sampleInterval = 1, unsigned int blockLength = 16,
+        unsigned int averagingLength = 2, unsigned int nLevels = 32);
+
+    //! Add a sample.
+    /*! \param value
+            The value of the observable.
+     */
+    void sample(double);
+
+    //! Clear all samples.
+    void reset();
+
+    //! Get the number of samples.
+    /*! \return
+            The number of samples accumulated since the last reset.
+     */
+    unsigned long long getNumSamples() const;
+
+    //! Get the mean of the observable.
+    /*! \return
+            The mean of all samples.
+     */
+    double getMean() const;
+
+    //! Get the autocorrelation function.
+    /*! \param lags
+            A vector in which to store the lag times.
+
+        \param correlation
+            A vector in which to store the correlation function at each lag time.
+
+        \param isConnected
+            Whether to subtract the squared mean, i.e. <A(0)A(t)> - <A>^2.
+
+        \param isNormalised
+            Whether to normalise the connected correlation function by its value at zero lag.
+     */
+    void getCorrelation(std::vector<double>&, std::vector<double>&,
+        bool isConnected = true, bool isNormalised = false) const;
+
+    //! Write the autocorrelation function to a plain text file.
+    /*! \param fileName
+            The path to the output file.
+
+        \param isNormalised
+            Whether to normalise the connected correlation function by its value at zero lag.
+     */
+    void save(std::string, bool isNormalised = false) const;
+
+private:
+    double sampleInterval;                                      //!< The time between samples.
+    unsigned int blockLength;                                   //!< The number of values stored at each level.
+    unsigned int averagingLength;                               //!< The number of values averaged between levels.
+    unsigned int nLevels;                                       //!< The number of levels.
+    unsigned int minLag;                                        //!< The smallest lag resolved at levels above zero.
+    unsigned int maxLevel;                                      //!< The highest level that has received a value.
+    unsigned long long nSamples;                                //!< The number of samples.
+    double sum;                                                 //!< The sum of all samples.
+
+    std::vector<std::vector<double> > shifts;                   //!< Shift register for each level.
+    std::vector<unsigned int> heads;                            //!< Next write position for each level.
+    std::vector<unsigned int> nStored;                          //!< Number of values stored at each level.
+    std::vector<double> accumulators;                           //!< Running sum for averaging into the next level.
+    std::vector<unsigned int> nAccumulated;                     //!< Number of values in each accumulator.
+    std::vector<std::vector<double> > sums;                     //!< Accumulated products for each level and lag.
+    std::vector<std::vector<unsigned long long> > counts;       //!< Number of accumulated products for each level and lag.
+
+    //! Push a value into a level.
+    /*! \param level
+            The level index.
+
+        \param value
+            The value.
+     */
+    void push(unsigned int, double);
+};
+
+#endif  /* _CORRELATOR_H */
@@ -0,0 +1,166 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "Box.h"
+#include "ExternalField.h"
+
+const unsigned int ExternalField::BLOCK_SIZE;
+
+ExternalField::ExternalField(Box& box_, const std::vector<unsigned int>& nGrid_,
+    const std::function<double (const double*)>& potential) :
+    box(box_),
+    nGrid(nGrid_)
+{
+    // Check dimensionality.
+    if ((box.dimension < 2) || (box.dimension > 3) || (nGrid.size() != box.dimension))
+    {
+        std::cerr << "[ERROR] ExternalField: Grid must be two or three dimensional and match the box!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Work out the layout of the grid nodes (including both boundaries).
+    unsigned int nNodes = 1;
+    strides.resize(box.dimension);
+    for (unsigned int i=0;i<box.dimension;i++)
+    {
+        if (nGrid[i] == 0)
+        {
+            std::cerr << "[ERROR] ExternalField: There must be at least one grid interval per dimension!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        strides[i] = nNodes;
+        nNodes *= nGrid[i] + 1;
+    }
+
+    values.resize(nNodes);
+
+    // Sample the potential at each node.
+    std::vector<double> position(box.dimension);
+    for (unsigned int i=0;i<nNodes;i++)
+    {
+        for (unsigned int j=0;j<box.dimension;j++)
+        {
+            unsigned int node = (i/strides[j]) % (nGrid[j] + 1);
+            position[j] = node*box.boxSize[j]/nGrid[j];
+        }
+
+        // Cap hard regions so that interpolated energies remain finite.
+        values[i] = std::min(potential(&position[0]), 1e10);
+    }
+}
+
+#ifndef ISOTROPIC
+double ExternalField::computeEnergy(unsigned int particle, const double* position, const double* orientation) const
+#else
+double ExternalField::computeEnergy(unsigned int particle, const double* position) const
+#endif
+{
+    double energy;
+    computeEnergies(1, position, &energy);
+
+    return energy;
+}
+
+void ExternalField::computeEnergies(unsigned int nPositions, const double* positions, double* energies) const
+{
+    unsigned int dimension = box.dimension;
+    unsigned int nCorners = 1 << dimension;
+
+    // Offset of each corner of a grid cell from its lowest node.
+    unsigned int cornerOffsets[8];
+    for (unsigned int i=0;i<nCorners;i++)
+    {
+        cornerOffsets[i] = 0;
+        for (unsigned int j=0;j<dimension;j++)
+            cornerOffsets[i] += ((i >> j) & 1)*strides[j];
+    }
+
+    unsigned int base[BLOCK_SIZE];
+    double fractions[3][BLOCK_SIZE];
+    double weights[BLOCK_SIZE];
+
+    for (unsigned int i=0;i<nPositions;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = std::min(BLOCK_SIZE, nPositions - i);
+        const double* block = positions + dimension*i;
+
+        for (unsigned int j=0;j<nBlock;j++)
+            base[j] = 0;
+
+        // Locate the grid cell containing each position, one axis at a time.
+        for (unsigned int j=0;j<dimension;j++)
+        {
+            double scale = nGrid[j]/box.boxSize[j];
+            double maxGrid = nGrid[j];
+
+            for (unsigned int k=0;k<nBlock;k++)
+            {
+                // Clamp to the box so that the lookup is always valid.
+                double x = std::min(std::max(block[dimension*k + j]*scale, 0.0), maxGrid);
+                unsigned int node = std::min((unsigned int) x, nGrid[j] - 1);
+
+                fractions[j][k] = x - node;
+                base[k] += node*strides[j];
+            }
+        }
+
+        for (unsigned int j=0;j<nBlock;j++)
+            energies[i + j] = 0;
+
+        // Accumulate the weighted energy at each corner of the cell.
+        for (unsigned int j=0;j<nCorners;j++)
+        {
+            for (unsigned int k=0;k<nBlock;k++)
+                weights[k] = 1;
+
+            for (unsigned int k=0;k<dimension;k++)
+            {
+                // Weight is the fraction for upper corners and one minus it for lower corners.
+                double bit = (j >> k) & 1;
+                double sign = 2*bit - 1;
+
+                for (unsigned int l=0;l<nBlock;l++)
+                    weights[l] *= (1 - bit) + sign*fractions[k][l];
+            }
+
+            for (unsigned int k=0;k<nBlock;k++)
+                energies[i + k] += weights[k]*values[base[k] + cornerOffsets[j]];
+        }
+    }
+}
+
+double ExternalField::computeTotalEnergy(unsigned int nPositions, const double* positions) const
+{
+    double energy = 0;
+    double energies[BLOCK_SIZE];
+
+    for (unsigned int i=0;i<nPositions;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = std::min(BLOCK_SIZE, nPositions - i);
+        computeEnergies(nBlock, positions + box.dimension*i, energies);
+
+        for (unsigned int j=0;j<nBlock;j++)
+            energy += energies[j];
+    }
+
+    return energy;
+}
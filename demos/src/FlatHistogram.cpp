@@ -0,0 +1,349 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "ClusterTracker.h"
+#include "FlatHistogram.h"
+
+FlatHistogram::FlatHistogram(ClusterTracker& clusterTracker_, CollectiveVariable variable_,
+    double minimum_, double maximum_, unsigned int nBins_, double modificationFactor_,
+    double finalModificationFactor_, double flatness_) :
+    clusterTracker(clusterTracker_),
+    variable(variable_),
+    minimum(minimum_),
+    maximum(maximum_),
+    nBins(nBins_),
+    modificationFactor(modificationFactor_),
+    finalModificationFactor(finalModificationFactor_),
+    flatness(flatness_),
+    isTrial(false),
+    isFrozen(false),
+    nIterations(0),
+    nObservations(0)
+{
+    // Check the window.
+    if ((maximum <= minimum) || (nBins == 0))
+    {
+        std::cerr << "[ERROR] FlatHistogram: Invalid sampling window!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Check the flatness criterion.
+    if ((flatness <= 0) || (flatness >= 1))
+    {
+        std::cerr << "[ERROR] FlatHistogram: Flatness criterion must be in range (0-1)!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    binWidth = (maximum - minimum)/nBins;
+
+    logWeights.assign(nBins, 0);
+    visits.assign(nBins, 0);
+    production.assign(nBins, 0);
+
+    value = computeValue();
+}
+
+double FlatHistogram::bias(unsigned int nMoving, const unsigned int* moveList)
+{
+    // Apply the trial move to the cluster tracker.
+    clusterTracker.update(nMoving, moveList);
+    trialValue = computeValue();
+    isTrial = true;
+
+    unsigned int oldBin = getBin(value);
+    unsigned int newBin = getBin(trialValue);
+
+    // Outside of the window: only allow moves towards it.
+    if (oldBin == nBins)
+    {
+        if (getDistance(trialValue) <= getDistance(value)) return 0;
+        else return INFINITY;
+    }
+
+    // Don't leave the window.
+    if (newBin == nBins) return INFINITY;
+
+    return logWeights[newBin] - logWeights[oldBin];
+}
+
+void FlatHistogram::observe(unsigned int nMoving, const unsigned int* moveList, bool isAccepted)
+{
+    if (isTrial)
+    {
+        // Restore the cluster tracker.
+        if (!isAccepted) clusterTracker.update(nMoving, moveList);
+        else value = trialValue;
+
+        isTrial = false;
+    }
+    else if (isAccepted)
+    {
+        // The move was accepted without consulting the bias.
+        clusterTracker.update(nMoving, moveList);
+        value = computeValue();
+    }
+
+    update();
+}
+
+double FlatHistogram::getValue() const
+{
+    return value;
+}
+
+bool FlatHistogram::isInWindow() const
+{
+    return (getBin(value) < nBins);
+}
+
+double FlatHistogram::getModificationFactor() const
+{
+    return modificationFactor;
+}
+
+unsigned int FlatHistogram::getNumIterations() const
+{
+    return nIterations;
+}
+
+bool FlatHistogram::isConverged() const
+{
+    return isFrozen;
+}
+
+void FlatHistogram::getFreeEnergy(std::vector<double>& centres, std::vector<double>& freeEnergy) const
+{
+    centres.resize(nBins);
+    freeEnergy.resize(nBins);
+
+    // Mean production histogram entry.
+    double mean = 0;
+    unsigned int nVisited = 0;
+    for (unsigned int i=0;i<nBins;i++)
+    {
+        if (production[i] > 0)
+        {
+            mean += production[i];
+            nVisited++;
+        }
+    }
+    if (nVisited > 0) mean /= nVisited;
+
+    double minFreeEnergy = INFINITY;
+
+    for (unsigned int i=0;i<nBins;i++)
+    {
+        centres[i] = minimum + (i + 0.5)*binWidth;
+        freeEnergy[i] = -logWeights[i];
+
+        // Correct for any residual non-flatness of the production histogram.
+        if (production[i] > 0) freeEnergy[i] -= std::log(production[i]/mean);
+
+        minFreeEnergy = std::min(minFreeEnergy, freeEnergy[i]);
+    }
+
+    for (unsigned int i=0;i<nBins;i++)
+        freeEnergy[i] -= minFreeEnergy;
+}
+
+void FlatHistogram::save(std::string fileName) const
+{
+    std::vector<double> centres, freeEnergy;
+    getFreeEnergy(centres, freeEnergy);
+
+    // Create file pointer.
+    FILE *pFile = fopen(fileName.c_str(), "w");
+
+    if (pFile == NULL)
+    {
+        std::cerr << "[ERROR] FlatHistogram: Unable to open file " << fileName << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int i=0;i<nBins;i++)
+        fprintf(pFile, "%.8e %.8e\n", centres[i], freeEnergy[i]);
+
+    // Close file pointer.
+    fclose(pFile);
+}
+
+void FlatHistogram::merge(const std::vector<const FlatHistogram*>& windows,
+    std::vector<double>& centres, std::vector<double>& freeEnergy)
+{
+    if (windows.size() == 0)
+    {
+        std::cerr << "[ERROR] FlatHistogram: No windows to merge!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Sort the windows by their lower edge.
+    std::vector<const FlatHistogram*> sorted(windows);
+    std::sort(sorted.begin(), sorted.end(),
+        [](const FlatHistogram* a, const FlatHistogram* b) { return a->minimum < b->minimum; });
+
+    double binWidth = sorted[0]->binWidth;
+    double minimum = sorted[0]->minimum;
+    double maximum = minimum;
+
+    // Check that the bins are aligned.
+    for (unsigned int i=0;i<sorted.size();i++)
+    {
+        double offset = (sorted[i]->minimum - minimum)/binWidth;
+
+        if ((std::abs(sorted[i]->binWidth - binWidth) > 1e-8*binWidth)
+            || (std::abs(offset - std::floor(0.5 + offset)) > 1e-6))
+        {
+            std::cerr << "[ERROR] FlatHistogram: Windows must have aligned bins of equal width!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        maximum = std::max(maximum, sorted[i]->maximum);
+    }
+
+    unsigned int nBins = (unsigned int) std::floor(0.5 + (maximum - minimum)/binWidth);
+
+    // Running sum of the shifted free energies and the number of windows contributing to each bin.
+    std::vector<double> sum(nBins, 0);
+    std::vector<unsigned int> count(nBins, 0);
+
+    std::vector<double> windowCentres, windowFreeEnergy;
+
+    for (unsigned int i=0;i<sorted.size();i++)
+    {
+        sorted[i]->getFreeEnergy(windowCentres, windowFreeEnergy);
+        unsigned int start = (unsigned int) std::floor(0.5 + (sorted[i]->minimum - minimum)/binWidth);
+
+        // Work out the shift that best matches the overlapping bins.
+        double shift = 0;
+        unsigned int nOverlap = 0;
+
+        for (unsigned int j=0;j<windowFreeEnergy.size();j++)
+        {
+            unsigned int bin = start + j;
+            if (count[bin] > 0)
+            {
+                shift += sum[bin]/count[bin] - windowFreeEnergy[j];
+                nOverlap++;
+            }
+        }
+
+        if ((i > 0) && (nOverlap == 0))
+        {
+            std::cerr << "[ERROR] FlatHistogram: Windows must overlap!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        if (nOverlap > 0) shift /= nOverlap;
+
+        for (unsigned int j=0;j<windowFreeEnergy.size();j++)
+        {
+            sum[start + j] += windowFreeEnergy[j] + shift;
+            count[start + j]++;
+        }
+    }
+
+    centres.resize(nBins);
+    freeEnergy.resize(nBins);
+
+    double minFreeEnergy = INFINITY;
+
+    for (unsigned int i=0;i<nBins;i++)
+    {
+        centres[i] = minimum + (i + 0.5)*binWidth;
+        freeEnergy[i] = sum[i]/count[i];
+        minFreeEnergy = std::min(minFreeEnergy, freeEnergy[i]);
+    }
+
+    for (unsigned int i=0;i<nBins;i++)
+        freeEnergy[i] -= minFreeEnergy;
+}
+
+double FlatHistogram::computeValue() const
+{
+    if (variable == ENERGY) return clusterTracker.getEnergy();
+    else return clusterTracker.getLargestClusterSize();
+}
+
+unsigned int FlatHistogram::getBin(double value) const
+{
+    if ((value < minimum) || (value >= maximum)) return nBins;
+
+    unsigned int bin = (unsigned int) ((value - minimum)/binWidth);
+    return std::min(bin, nBins - 1);
+}
+
+double FlatHistogram::getDistance(double value) const
+{
+    if (value < minimum) return minimum - value;
+    else if (value >= maximum) return value - maximum;
+    else return 0;
+}
+
+void FlatHistogram::update()
+{
+    unsigned int bin = getBin(value);
+
+    // Still equilibrating towards the window.
+    if (bin == nBins) return;
+
+    // Multicanonical production run.
+    if (isFrozen)
+    {
+        production[bin]++;
+        return;
+    }
+
+    // Wang-Landau update (the modification factor is applied once per sweep).
+    logWeights[bin] += modificationFactor/clusterTracker.getNumParticles();
+    visits[bin]++;
+    nObservations++;
+
+    // Periodically check the flatness of the histogram.
+    if (nObservations == 1000*nBins)
+    {
+        nObservations = 0;
+
+        double mean = 0;
+        unsigned long long minVisits = visits[0];
+        for (unsigned int i=0;i<nBins;i++)
+        {
+            mean += visits[i];
+            minVisits = std::min(minVisits, visits[i]);
+        }
+        mean /= nBins;
+
+        if (minVisits > flatness*mean)
+        {
+            modificationFactor *= 0.5;
+            nIterations++;
+            std::fill(visits.begin(), visits.end(), 0);
+
+            // Shift the weights to avoid overflow.
+            double maxWeight = *std::max_element(logWeights.begin(), logWeights.end());
+            for (unsigned int i=0;i<nBins;i++)
+                logWeights[i] -= maxWeight;
+
+            if (modificationFactor < finalModificationFactor) isFrozen = true;
+        }
+    }
+}
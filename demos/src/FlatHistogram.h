@@ -0,0 +1,235 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FLATHISTOGRAM_H
+#define _FLATHISTOGRAM_H
+
+#include <string>
+#include <vector>
+
+/*! \file FlatHistogram.h
+    \brief Wang-Landau / multicanonical flat-histogram sampling of a
+    collective variable.
+
+    The collective variable, either the total bond energy or the size of the
+    largest cluster, is read from an incrementally updated ClusterTracker.
+    Bind FlatHistogram::bias to the VMMC bias callback and
+    FlatHistogram::observe to the observer callback. When a trial move has
+    been applied the bias updates the tracker and returns the change in the
+    bias potential, ln g(new) - ln g(old), where g is the current estimate
+    of the probability distribution of the collective variable. If the move
+    is rejected the tracker is restored when the outcome is observed.
+
+    Following each trial move, including moves that the engine aborts
+    before they are applied, the log weight of the current bin is
+    incremented by ln f / N, where N is the number of particles, i.e. the
+    modification factor, ln f, is applied once per sweep. (Most single
+    particle moves don't change the collective variable, so applying the
+    full factor per move would leave large residual errors in the weights.)
+    Once the visit histogram is flat, ln f is halved and the histogram is
+    reset. When ln f falls below its final value the weights are frozen and
+    sampling continues as a multicanonical production run, the visit
+    histogram of which is used to refine the free-energy estimate.
+
+    Sampling is restricted to a window of the collective variable. Moves
+    leaving the window are rejected, while a system that starts outside of
+    the window is only allowed to move towards it. Independent walkers can
+    therefore sample overlapping windows in parallel, with the resulting
+    free-energy profiles stitched together by FlatHistogram::merge.
+*/
+
+// FORWARD DECLARATIONS
+
+class ClusterTracker;
+
+//! Class for flat-histogram sampling of a collective variable.
+class FlatHistogram
+{
+public:
+    //! The collective variable.
+    enum CollectiveVariable
+    {
+        ENERGY,             //!< The total bond energy.
+        LARGEST_CLUSTER     //!< The size of the largest cluster.
+    };
+
+    //! Constructor.
+    /*! \param clusterTracker_
+            A reference to the cluster tracker.
+
+        \param variable_
+            The collective variable.
+
+        \param minimum_
+            The lower edge of the sampling window.
+
+        \param maximum_
+            The upper edge of the sampling window.
+
+        \param nBins_
+            The number of histogram bins.
+
+        \param modificationFactor_
+            The initial Wang-Landau modification factor, ln f.
+
+        \param finalModificationFactor_
+            The modification factor below which the weights are frozen.
+
+        \param flatness_
+            The flatness criterion, i.e. the minimum ratio of the smallest
+            histogram entry to the mean.
+     */
+    FlatHistogram(ClusterTracker&, CollectiveVariable, double, double, unsigned int,
+        double modificationFactor_ = 1.0, double finalModificationFactor_ = 1e-5, double flatness_ = 0.8);
+
+    //! Compute the change in the bias potential (bind to the VMMC bias callback).
+    /*! \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \return
+            The change in the bias potential (in units of kBT).
+     */
+    double bias(unsigned int, const unsigned int*);
+
+    //! Observe the outcome of a trial move (bind to the VMMC observer callback).
+    /*! \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \param isAccepted
+            Whether the move was accepted.
+     */
+    void observe(unsigned int, const unsigned int*, bool);
+
+    //! Get the current value of the collective variable.
+    /*! \return
+            The value of the collective variable.
+     */
+    double getValue() const;
+
+    //! Whether the collective variable lies within the window.
+    /*! \return
+            Whether the system is inside the sampling window.
+     */
+    bool isInWindow() const;
+
+    //! Get the current modification factor.
+    /*! \return
+            The Wang-Landau modification factor, ln f.
+     */
+    double getModificationFactor() const;
+
+    //! Get the number of completed Wang-Landau iterations.
+    /*! \return
+            The number of times that the modification factor has been reduced.
+     */
+    unsigned int getNumIterations() const;
+
+    //! Whether the weights have been frozen.
+    /*! \return
+            Whether the simulation is in the multicanonical production stage.
+     */
+    bool isConverged() const;
+
+    //! Get the free-energy profile of the collective variable.
+    /*! \param centres
+            A vector in which to store the bin centres.
+
+        \param freeEnergy
+            A vector in which to store the free energy of each bin
+            (in units of kBT, with a minimum of zero).
+     */
+    void getFreeEnergy(std::vector<double>&, std::vector<double>&) const;
+
+    //! Save the free-energy profile to file.
+    /*! \param fileName
+            The path of the output file.
+     */
+    void save(std::string) const;
+
+    //! Stitch together the free-energy profiles from overlapping windows.
+    /*! Windows must share a common bin width with aligned bin edges. Each
+        profile is shifted to minimise the mean-squared deviation from the
+        windows already merged over their overlapping bins.
+
+        \param windows
+            The flat-histogram objects for each window.
+
+        \param centres
+            A vector in which to store the bin centres.
+
+        \param freeEnergy
+            A vector in which to store the merged free energy of each bin.
+     */
+    static void merge(const std::vector<const FlatHistogram*>&, std::vector<double>&, std::vector<double>&);
+
+private:
+    ClusterTracker& clusterTracker;         //!< A reference to the cluster tracker.
+    CollectiveVariable variable;            //!< The collective variable.
+    double minimum;                         //!< The lower edge of the window.
+    double maximum;                         //!< The upper edge of the window.
+    unsigned int nBins;                     //!< The number of bins.
+    double binWidth;                        //!< The bin width.
+    double modificationFactor;              //!< The Wang-Landau modification factor, ln f.
+    double finalModificationFactor;         //!< The final modification factor.
+    double flatness;                        //!< The flatness criterion.
+
+    double value;                           //!< The current value of the collective variable.
+    double trialValue;                      //!< The value of the collective variable following a trial move.
+    bool isTrial;                           //!< Whether a trial move is awaiting its outcome.
+    bool isFrozen;                          //!< Whether the weights are frozen.
+    unsigned int nIterations;               //!< The number of Wang-Landau iterations.
+    unsigned long long nObservations;       //!< The number of observations since the last flatness check.
+
+    std::vector<double> logWeights;         //!< The log of the estimated probability of each bin.
+    std::vector<unsigned long long> visits; //!< The visit histogram of the current iteration.
+    std::vector<unsigned long long> production;     //!< The visit histogram with frozen weights.
+
+    //! Compute the collective variable from the cluster tracker.
+    /*! \return
+            The value of the collective variable.
+     */
+    double computeValue() const;
+
+    //! Get the bin index for a value of the collective variable.
+    /*! \param value
+            The value of the collective variable.
+
+        \return
+            The bin index (nBins if outside of the window).
+     */
+    unsigned int getBin(double) const;
+
+    //! Get the distance from a value of the collective variable to the window.
+    /*! \param value
+            The value of the collective variable.
+
+        \return
+            The distance to the window (zero if inside).
+     */
+    double getDistance(double) const;
+
+    //! Update the weights and check the flatness of the visit histogram.
+    void update();
+};
+
+#endif  /* _FLATHISTOGRAM_H */
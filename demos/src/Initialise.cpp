@@ -15,11 +15,13 @@
   along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 
 #include "Box.h"
 #include "CellList.h"
+#include "MultiCellList.h"
 #include "Particle.h"
 #include "Initialise.h"
 #include "MersenneTwister.h"
@@ -117,6 +119,76 @@ void Initialise::random(std::vector<Particle>& particles, CellList& cells, Box&
     }
 }
 
+void Initialise::random(std::vector<Particle>& particles, MultiCellList& multiCells, Box& box, MersenneTwister& rng)
+{
+    // Copy box dimensions.
+    boxSize = box.boxSize;
+
+    // Set particle indices and sort by decreasing radius.
+    std::vector<std::pair<double, unsigned int> > order(particles.size());
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        particles[i].index = i;
+        order[i] = std::make_pair(-particles[i].radius, i);
+    }
+    std::sort(order.begin(), order.end());
+
+    // Temporary vector.
+    std::vector<double> vec(box.dimension);
+
+    for (unsigned int n=0;n<particles.size();n++)
+    {
+        unsigned int i = order[n].second;
+
+        // Current number of attempted particle insertions.
+        unsigned int nTrials = 0;
+
+        // Whether particle overlaps.
+        bool isOverlap = true;
+
+        // Keep trying to insert particle until there is no overlap.
+        while (isOverlap)
+        {
+            nTrials++;
+
+            // Generate a random position.
+            for (unsigned int j=0;j<box.dimension;j++)
+                vec[j] = rng()*box.boxSize[j];
+
+            particles[i].position = vec;
+
+            // Generate a random orientation.
+            for (unsigned int j=0;j<box.dimension;j++)
+                vec[j] = rng.normal();
+
+            // Calculate vector norm.
+            double norm = 0;
+            for (unsigned int j=0;j<box.dimension;j++)
+                norm += vec[j]*vec[j];
+            norm = sqrt(norm);
+
+            // Convert orientation to a unit vector.
+            for (unsigned int j=0;j<box.dimension;j++)
+                vec[j] /= norm;
+
+            particles[i].orientation = vec;
+
+            // See if there is any overlap between particles.
+            isOverlap = checkOverlap(particles[i], particles, multiCells, box);
+
+            // Check trial limit isn't exceeded.
+            if (nTrials == MAX_TRIALS)
+            {
+                std::cerr << "[ERROR] Initialise: Maximum number of trial insertions reached.\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // Update cell list.
+        multiCells.initCell(particles[i]);
+    }
+}
+
 #ifndef ISOTROPIC
 bool Initialise::outsideSpherocylinder(unsigned int particle, const double* position, const double* orientation)
 #else
@@ -231,3 +303,54 @@ bool Initialise::checkOverlap(Particle& particle, std::vector<Particle>& particl
     // If we get this far, no overlaps.
     return false;
 }
+
+bool Initialise::checkOverlap(Particle& particle, std::vector<Particle>& particles, MultiCellList& multiCells, Box& box)
+{
+    // Cells overlapping the exclusion sphere.
+    std::vector<unsigned int> cellList;
+
+    // Check all levels.
+    for (unsigned int i=0;i<multiCells.size();i++)
+    {
+        unsigned int nCells = multiCells.computeCells(i, &particle.position[0],
+            particle.radius + multiCells.getMaxRadius(i), cellList);
+
+        for (unsigned int j=0;j<nCells;j++)
+        {
+            const Cell& cell = multiCells[i][cellList[j]];
+
+            // Check all particles within cell.
+            for (unsigned int k=0;k<cell.tally;k++)
+            {
+                unsigned int neighbour = cell.particles[k];
+
+                // Make sure particles are different.
+                if (neighbour != particle.index)
+                {
+                    // Particle separtion vector.
+                    std::vector<double> sep(box.dimension);
+
+                    // Compute separation.
+                    for (unsigned int l=0;l<box.dimension;l++)
+                        sep[l] = particle.position[l] - particles[neighbour].position[l];
+
+                    // Compute minimum image.
+                    box.minimumImage(sep);
+
+                    double normSqd = 0;
+
+                    // Calculate squared norm of vector.
+                    for (unsigned int l=0;l<box.dimension;l++)
+                        normSqd += sep[l]*sep[l];
+
+                    // Overlap if normSqd is less than the contact distance.
+                    double sigma = particle.radius + particles[neighbour].radius;
+                    if (normSqd < sigma*sigma) return true;
+                }
+            }
+        }
+    }
+
+    // If we get this far, no overlaps.
+    return false;
+}
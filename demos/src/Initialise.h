@@ -25,6 +25,7 @@
 
 class  Box;
 class  CellList;
+class  MultiCellList;
 struct Particle;
 class  MersenneTwister;
 
@@ -53,6 +54,24 @@ public:
      */
     void random(std::vector<Particle>&, CellList&, Box&, MersenneTwister&, bool);
 
+    //! Initialise a random configuration of polydisperse particles.
+    /*! Particles are inserted in order of decreasing radius. The radii
+        must be set, and the multi-level cell list initialised, beforehand.
+
+        \param particles
+            A reference to a vector of particles.
+
+        \param multiCells
+            A reference to the multi-level cell list container.
+
+        \param box
+            A reference to the simulation box.
+
+        \param rng
+            A reference to the random number generator.
+     */
+    void random(std::vector<Particle>&, MultiCellList&, Box&, MersenneTwister&);
+
     //! Check whether particle is within spherocylinder.
     /*! \param index
             The particle index.
@@ -91,6 +110,21 @@ private:
      */
     bool checkOverlap(Particle&, std::vector<Particle>&, CellList&, Box&);
 
+    //! Helper function for testing polydisperse particle insertions.
+    /*! \param particle
+            A reference to the trial particle.
+
+        \param particles
+            A reference to the particle list.
+
+        \param multiCells
+            A reference to the multi-level cell list.
+
+        \param box
+            A reference to the simulation box.
+     */
+    bool checkOverlap(Particle&, std::vector<Particle>&, MultiCellList&, Box&);
+
     /// Maximum number of trial particle insertions (per particle).
     static const unsigned int MAX_TRIALS = 100000000;
 };
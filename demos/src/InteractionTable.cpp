@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "InteractionTable.h"
+
+// The number of doubles in a 64 byte cache line.
+static const unsigned int CACHE_LINE = 8;
+
+InteractionTable::InteractionTable() : nTypes(0), stride(0),
+    energies(nullptr), squaredContacts(nullptr), squaredCutOffs(nullptr)
+{
+}
+
+InteractionTable::InteractionTable(unsigned int nTypes_)
+{
+    setNumTypes(nTypes_);
+}
+
+InteractionTable::InteractionTable(const InteractionTable& table)
+{
+    *this = table;
+}
+
+InteractionTable& InteractionTable::operator = (const InteractionTable& table)
+{
+    if (this != &table)
+    {
+        nTypes = table.nTypes;
+        stride = table.stride;
+        allocate();
+
+        // Copy the tables (the alignment offset may differ).
+        std::copy(table.energies, table.energies + nTypes*stride, energies);
+        std::copy(table.squaredContacts, table.squaredContacts + nTypes*stride, squaredContacts);
+        std::copy(table.squaredCutOffs, table.squaredCutOffs + nTypes*stride, squaredCutOffs);
+    }
+
+    return *this;
+}
+
+void InteractionTable::setNumTypes(unsigned int nTypes_)
+{
+    if (nTypes_ == 0)
+    {
+        std::cerr << "[ERROR] InteractionTable: Number of types must be greater than zero!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    nTypes = nTypes_;
+
+    // Pad each row to a whole number of cache lines.
+    stride = CACHE_LINE*((nTypes + CACHE_LINE - 1)/CACHE_LINE);
+
+    allocate();
+
+    // Default to hard spheres of unit diameter.
+    std::fill(energies, energies + nTypes*stride, 0);
+    std::fill(squaredContacts, squaredContacts + nTypes*stride, 1);
+    std::fill(squaredCutOffs, squaredCutOffs + nTypes*stride, 1);
+}
+
+unsigned int InteractionTable::getNumTypes() const
+{
+    return nTypes;
+}
+
+void InteractionTable::set(unsigned int type1, unsigned int type2, double energy, double range, double contact)
+{
+    checkType(type1);
+    checkType(type2);
+
+    if ((contact <= 0) || (range < 1))
+    {
+        std::cerr << "[ERROR] InteractionTable: Invalid contact distance or range!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    double cutOff = range*contact;
+
+    energies[type1*stride + type2] = energy;
+    energies[type2*stride + type1] = energy;
+    squaredContacts[type1*stride + type2] = contact*contact;
+    squaredContacts[type2*stride + type1] = contact*contact;
+    squaredCutOffs[type1*stride + type2] = cutOff*cutOff;
+    squaredCutOffs[type2*stride + type1] = cutOff*cutOff;
+}
+
+const double* InteractionTable::getEnergies(unsigned int type) const
+{
+    return energies + type*stride;
+}
+
+const double* InteractionTable::getSquaredContacts(unsigned int type) const
+{
+    return squaredContacts + type*stride;
+}
+
+const double* InteractionTable::getSquaredCutOffs(unsigned int type) const
+{
+    return squaredCutOffs + type*stride;
+}
+
+double InteractionTable::getMaxCutOff() const
+{
+    double maxSquaredCutOff = 0;
+
+    for (unsigned int i=0;i<nTypes;i++)
+    {
+        for (unsigned int j=0;j<nTypes;j++)
+            maxSquaredCutOff = std::max(maxSquaredCutOff, squaredCutOffs[i*stride + j]);
+    }
+
+    return std::sqrt(maxSquaredCutOff);
+}
+
+void InteractionTable::allocate()
+{
+    // Allocate an extra cache line so that the tables can be aligned.
+    storage.assign(3*nTypes*stride + CACHE_LINE, 0);
+
+    // Offset (in doubles) to the first cache line boundary.
+    unsigned int offset = ((64 - (reinterpret_cast<std::uintptr_t>(&storage[0]) % 64)) % 64)/sizeof(double);
+
+    energies = &storage[offset];
+    squaredContacts = energies + nTypes*stride;
+    squaredCutOffs = squaredContacts + nTypes*stride;
+}
+
+void InteractionTable::checkType(unsigned int type) const
+{
+    if (type >= nTypes)
+    {
+        std::cerr << "[ERROR] InteractionTable: Invalid particle type!\n";
+        exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _INTERACTIONTABLE_H
+#define _INTERACTIONTABLE_H
+
+#include <vector>
+
+/*! \file InteractionTable.h
+    \brief A dense table of pair parameters for multicomponent mixtures.
+
+    The interaction between species i and j is described by a well depth,
+    a contact (hard core) distance, and a cut-off range in units of the
+    contact distance. The parameters are stored as three separate
+    nTypes x nTypes arrays of doubles, i.e. structure-of-arrays, with each
+    row padded to a whole number of 64 byte cache lines and the storage
+    aligned to a cache line boundary. The row for a given species can then
+    be fetched once, with the parameters for each neighbour gathered by
+    indexing the row with the neighbour's species.
+*/
+
+//! Class for storing the pair parameters between particle species.
+class InteractionTable
+{
+public:
+    //! Default constructor.
+    InteractionTable();
+
+    //! Constructor.
+    /*! \param nTypes_
+            The number of particle species.
+     */
+    InteractionTable(unsigned int);
+
+    //! Copy constructor.
+    /*! \param table
+            A reference to an existing InteractionTable object.
+     */
+    InteractionTable(const InteractionTable&);
+
+    //! Assignment operator.
+    /*! \param table
+            A reference to an existing InteractionTable object.
+     */
+    InteractionTable& operator = (const InteractionTable&);
+
+    //! Set the number of species (all pair parameters are reset).
+    /*! By default, pairs have zero well depth and unit contact distance
+        and range, i.e. they are hard spheres of unit diameter.
+
+        \param nTypes_
+            The number of particle species.
+     */
+    void setNumTypes(unsigned int);
+
+    //! Get the number of species.
+    /*! \return
+            The number of particle species.
+     */
+    unsigned int getNumTypes() const;
+
+    //! Set the parameters for a pair of species (the table is symmetric).
+    /*! \param type1
+            The first species.
+
+        \param type2
+            The second species.
+
+        \param energy
+            The well depth (in units of kBT).
+
+        \param range
+            The interaction range (in units of the contact distance).
+
+        \param contact
+            The contact distance.
+     */
+    void set(unsigned int, unsigned int, double, double, double contact = 1.0);
+
+    //! Get the well depth for each partner of a species.
+    /*! \param type
+            The species.
+
+        \return
+            A pointer to the row of well depths.
+     */
+    const double* getEnergies(unsigned int) const;
+
+    //! Get the squared contact distance for each partner of a species.
+    /*! \param type
+            The species.
+
+        \return
+            A pointer to the row of squared contact distances.
+     */
+    const double* getSquaredContacts(unsigned int) const;
+
+    //! Get the squared cut-off distance for each partner of a species.
+    /*! \param type
+            The species.
+
+        \return
+            A pointer to the row of squared cut-off distances.
+     */
+    const double* getSquaredCutOffs(unsigned int) const;
+
+    //! Get the largest cut-off distance in the table.
+    /*! \return
+            The maximum cut-off distance (used to size the cell list).
+     */
+    double getMaxCutOff() const;
+
+private:
+    unsigned int nTypes;            //!< The number of species.
+    unsigned int stride;            //!< The padded length of each row.
+    std::vector<double> storage;    //!< The raw storage.
+    double* energies;               //!< The (aligned) table of well depths.
+    double* squaredContacts;        //!< The (aligned) table of squared contact distances.
+    double* squaredCutOffs;         //!< The (aligned) table of squared cut-off distances.
+
+    //! Allocate the aligned storage.
+    void allocate();
+
+    //! Check that a species index is valid.
+    /*! \param type
+            The species.
+     */
+    void checkType(unsigned int) const;
+};
+
+#endif  /* _INTERACTIONTABLE_H */
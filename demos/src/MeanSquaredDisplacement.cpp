@@ -0,0 +1,170 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "MeanSquaredDisplacement.h"
+
+MeanSquaredDisplacement::MeanSquaredDisplacement(unsigned int nParticles_, unsigned int dimension_,
+    double sampleInterval_, unsigned int blockLength_) :
+    nParticles(nParticles_),
+    dimension(dimension_),
+    sampleInterval(sampleInterval_),
+    blockLength(blockLength_)
+{
+    // Check block length.
+    if ((blockLength < 2) || (blockLength % 2 != 0))
+    {
+        std::cerr << "[ERROR] MeanSquaredDisplacement: Block length must be even and at least two!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    reset();
+}
+
+void MeanSquaredDisplacement::sample(const double* coordinates)
+{
+    // Store the first sample.
+    if (nSamples == 0)
+        origin.assign(coordinates, coordinates + dimension*nParticles);
+
+    // Level k receives every 2^k-th sample. A new level is created once
+    // the sample index reaches its stride.
+    unsigned int level = 0;
+    while (true)
+    {
+        if (level == buffers.size()) addLevel();
+        push(level, coordinates);
+
+        level++;
+        if ((level == 64) || (nSamples % (1ULL << level) != 0) || (nSamples < (1ULL << level)))
+            break;
+    }
+
+    nSamples++;
+}
+
+void MeanSquaredDisplacement::reset()
+{
+    nSamples = 0;
+    origin.clear();
+    buffers.clear();
+    heads.clear();
+    nStored.clear();
+    sums.clear();
+    counts.clear();
+}
+
+unsigned long long MeanSquaredDisplacement::getNumSamples() const
+{
+    return nSamples;
+}
+
+void MeanSquaredDisplacement::getMeanSquaredDisplacement(std::vector<double>& lags, std::vector<double>& msd) const
+{
+    lags.clear();
+    msd.clear();
+
+    for (unsigned int i=0;i<sums.size();i++)
+    {
+        for (unsigned int j=1;j<blockLength;j++)
+        {
+            if (counts[i][j] > 0)
+            {
+                lags.push_back(j*double(1ULL << i)*sampleInterval);
+                msd.push_back(sums[i][j]/counts[i][j]);
+            }
+        }
+    }
+}
+
+void MeanSquaredDisplacement::save(std::string fileName) const
+{
+    std::vector<double> lags, msd;
+    getMeanSquaredDisplacement(lags, msd);
+
+    // Create file pointer.
+    FILE *pFile = fopen(fileName.c_str(), "w");
+
+    if (pFile == NULL)
+    {
+        std::cerr << "[ERROR] MeanSquaredDisplacement: Unable to open file " << fileName << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int i=0;i<lags.size();i++)
+        fprintf(pFile, "%.8e %.8e\n", lags[i], msd[i]);
+
+    // Close file pointer.
+    fclose(pFile);
+}
+
+void MeanSquaredDisplacement::addLevel()
+{
+    unsigned int nCoordinates = dimension*nParticles;
+
+    buffers.push_back(std::vector<double>(blockLength*nCoordinates));
+    heads.push_back(0);
+    nStored.push_back(0);
+    sums.push_back(std::vector<double>(blockLength, 0));
+    counts.push_back(std::vector<unsigned long long>(blockLength, 0));
+
+    // Seed levels beyond the first with the initial configuration.
+    unsigned int level = buffers.size() - 1;
+    if (level > 0)
+    {
+        std::copy(origin.begin(), origin.end(), buffers[level].begin());
+        heads[level] = 1;
+        nStored[level] = 1;
+    }
+}
+
+void MeanSquaredDisplacement::push(unsigned int level, const double* coordinates)
+{
+    unsigned int nCoordinates = dimension*nParticles;
+    std::vector<double>& buffer = buffers[level];
+
+    // Lags below half a block are resolved by the level beneath.
+    unsigned int minLag = (level == 0) ? 1 : blockLength/2;
+
+    for (unsigned int i=minLag;i<=nStored[level];i++)
+    {
+        if (i == blockLength) break;
+
+        // Index of the sample i steps in the past.
+        unsigned int index = (heads[level] + blockLength - i) % blockLength;
+        const double* previous = &buffer[index*nCoordinates];
+
+        double sum = 0;
+        for (unsigned int j=0;j<nCoordinates;j++)
+        {
+            double delta = coordinates[j] - previous[j];
+            sum += delta*delta;
+        }
+
+        sums[level][i] += sum/nParticles;
+        counts[level][i]++;
+    }
+
+    // Store the sample.
+    std::copy(coordinates, coordinates + nCoordinates, &buffer[heads[level]*nCoordinates]);
+    heads[level] = (heads[level] + 1) % blockLength;
+    if (nStored[level] < blockLength) nStored[level]++;
+}
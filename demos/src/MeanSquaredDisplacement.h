@@ -0,0 +1,113 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MEANSQUAREDDISPLACEMENT_H
+#define _MEANSQUAREDDISPLACEMENT_H
+
+#include <string>
+#include <vector>
+
+/*! \file MeanSquaredDisplacement.h
+    \brief An online multi-tau accumulator for the mean-squared displacement.
+
+    Unwrapped coordinates (see VMMC::getUnwrappedCoordinates) are stored in
+    a hierarchy of circular buffers, each holding blockLength samples. Level
+    k receives every 2^k-th sample, so lag times from one sample interval up
+    to the full length of the simulation are covered on a logarithmic grid
+    using O(blockLength log(t)) configurations of memory. Level zero resolves
+    lags 1 to blockLength-1, while higher levels only accumulate the lags
+    that aren't already resolved by the level beneath.
+*/
+
+//! Class for accumulating the mean-squared displacement on the fly.
+class MeanSquaredDisplacement
+{
+public:
+    //! Constructor.
+    /*! \param nParticles
+            The number of particles.
+
+        \param dimension
+            The dimension of the simulation box.
+
+        \param sampleInterval
+            The time between samples (e.g. in Monte Carlo sweeps).
+
+        \param blockLength
+            The number of samples stored at each level (must be even).
+     */
+    MeanSquaredDisplacement(unsigned int, unsigned int, double sampleInterval = 1, unsigned int blockLength = 16);
+
+    //! Add a sample.
+    /*! \param coordinates
+            The unwrapped coordinates of all particles,
+            i.e. x1, y1, z1, x2, y2, z2, ... , xN, yN, zN.
+     */
+    void sample(const double*);
+
+    //! Clear all samples.
+    void reset();
+
+    //! Get the number of samples.
+    /*! \return
+            The number of samples accumulated since the last reset.
+     */
+    unsigned long long getNumSamples() const;
+
+    //! Get the mean-squared displacement.
+    /*! \param lags
+            A vector in which to store the lag times.
+
+        \param msd
+            A vector in which to store the mean-squared displacement at each lag time.
+     */
+    void getMeanSquaredDisplacement(std::vector<double>&, std::vector<double>&) const;
+
+    //! Write the mean-squared displacement to a plain text file.
+    /*! \param fileName
+            The path to the output file.
+     */
+    void save(std::string) const;
+
+private:
+    unsigned int nParticles;                                    //!< The number of particles.
+    unsigned int dimension;                                     //!< The dimension of the simulation box.
+    double sampleInterval;                                      //!< The time between samples.
+    unsigned int blockLength;                                   //!< The number of samples stored at each level.
+    unsigned long long nSamples;                                //!< The number of samples.
+
+    std::vector<double> origin;                                 //!< The first sample (seeds new levels).
+    std::vector<std::vector<double> > buffers;                  //!< Circular coordinate buffer for each level.
+    std::vector<unsigned int> heads;                            //!< Next write position for each level.
+    std::vector<unsigned int> nStored;                          //!< Number of samples stored at each level.
+    std::vector<std::vector<double> > sums;                     //!< Accumulated squared displacements for each level and lag.
+    std::vector<std::vector<unsigned long long> > counts;       //!< Number of accumulated values for each level and lag.
+
+    //! Add a level to the hierarchy.
+    void addLevel();
+
+    //! Push a sample into a level and accumulate displacements.
+    /*! \param level
+            The level index.
+
+        \param coordinates
+            The coordinates of all particles.
+     */
+    void push(unsigned int, const double*);
+};
+
+#endif  /* _MEANSQUAREDDISPLACEMENT_H */
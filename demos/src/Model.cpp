@@ -164,6 +164,54 @@ unsigned int Model::computeInteractions(unsigned int particle,
     return nInteractions;
 }
 
+unsigned int Model::computeNeighbours(unsigned int particle, double distance, unsigned int* neighbours)
+{
+    // Neighbour counter.
+    unsigned int nNeighbours = 0;
+
+    // The search extends beyond the neighbouring cells, report every particle.
+    const std::vector<double>& cellSpacing = cells.getCellSpacing();
+    for (unsigned int i=0;i<box.dimension;i++)
+    {
+        if (distance > cellSpacing[i])
+        {
+            for (unsigned int j=0;j<particles.size();j++)
+            {
+                if (j != particle)
+                {
+                    neighbours[nNeighbours] = j;
+                    nNeighbours++;
+                }
+            }
+
+            return nNeighbours;
+        }
+    }
+
+    // Check all neighbouring cells including same cell.
+    for (unsigned int i=0;i<cells.getNeighbours();i++)
+    {
+        // Cell index.
+        unsigned int cell = cells[particles[particle].cell].neighbours[i];
+
+        // Check all particles within cell.
+        for (unsigned int j=0;j<cells[cell].tally;j++)
+        {
+            // Index of neighbouring particle.
+            unsigned int neighbour = cells[cell].particles[j];
+
+            // Make sure the particles are different.
+            if (neighbour != particle)
+            {
+                neighbours[nNeighbours] = neighbour;
+                nNeighbours++;
+            }
+        }
+    }
+
+    return nNeighbours;
+}
+
 #ifndef ISOTROPIC
 void Model::applyPostMoveUpdates(unsigned int particle, const double* position, const double* orientation)
 #else
@@ -187,6 +235,34 @@ void Model::applyPostMoveUpdates(unsigned int particle, const double* position)
         cells.updateCell(newCell, particles[particle], particles);
 }
 
+bool Model::setBoxSize(const double* boxSize)
+{
+    std::vector<double> newBoxSize(boxSize, boxSize + box.dimension);
+
+    // The box is too small for the cell list.
+    if (!cells.isValidBox(newBoxSize)) return false;
+
+    // Affinely rescale particle positions.
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        for (unsigned int j=0;j<box.dimension;j++)
+        {
+            particles[i].position[j] *= newBoxSize[j]/box.boxSize[j];
+
+            // Guard against rounding at the box boundary.
+            if (particles[i].position[j] >= newBoxSize[j]) particles[i].position[j] = 0;
+        }
+    }
+
+    // Update the simulation box.
+    box.setSize(newBoxSize);
+
+    // Update the cell list, rebuilding if necessary.
+    cells.rescale(newBoxSize, particles);
+
+    return true;
+}
+
 double Model::getEnergy()
 {
     double energy = 0;
@@ -200,3 +276,29 @@ double Model::getEnergy()
 
     return energy/(2*particles.size());
 }
+
+unsigned int Model::getMaxInteractions() const
+{
+    return maxInteractions;
+}
+
+unsigned int Model::gatherCandidates(unsigned int particle, std::vector<unsigned int>& candidates) const
+{
+    candidates.clear();
+
+    // Check all neighbouring cells including same cell.
+    for (unsigned int i=0;i<cells.getNeighbours();i++)
+    {
+        // Cell index.
+        unsigned int cell = cells[particles[particle].cell].neighbours[i];
+
+        // Add all other particles within the cell.
+        for (unsigned int j=0;j<cells[cell].tally;j++)
+        {
+            unsigned int neighbour = cells[cell].particles[j];
+            if (neighbour != particle) candidates.push_back(neighbour);
+        }
+    }
+
+    return candidates.size();
+}
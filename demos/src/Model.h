@@ -126,6 +126,25 @@ public:
     virtual unsigned int computeInteractions(unsigned int, const double*, unsigned int*);
 #endif
 
+    //! Find the particles close to a given particle.
+    /*! Particles in the cells neighbouring that of the particle are
+        reported. If the distance exceeds the cell spacing then every other
+        particle is reported.
+
+        \param particle
+            The particle index.
+
+        \param distance
+            The search distance.
+
+        \param neighbours
+            An array to store the indices of the neighbouring particles.
+
+        \return
+            The number of neighbours.
+     */
+    virtual unsigned int computeNeighbours(unsigned int, double, unsigned int*);
+
     //! Apply any post-move updates for a given particle.
     /*! \param particle
             The particle index.
@@ -142,17 +161,49 @@ public:
     virtual void applyPostMoveUpdates(unsigned int, const double*);
 #endif
 
+    //! Set the size of the simulation box, e.g. following a volume move.
+    /*! Particle positions are rescaled affinely with the box so that the
+        cell list remains valid. Exact positions should be set afterwards
+        using applyPostMoveUpdates. If the box is too small for the cell
+        list the model is left unchanged.
+
+        \param boxSize
+            The new size of the simulation box in each dimension.
+
+        \return
+            Whether the box size was updated.
+     */
+    virtual bool setBoxSize(const double*);
+
     //! Get the average pair energy.
     /*! \return
             The average pair energy.
      */
     double getEnergy();
 
+    //! Get the maximum number of interactions per particle.
+    /*! \return
+            The maximum number of interactions.
+     */
+    unsigned int getMaxInteractions() const;
+
     Box& box;                           //!< A reference to the simulation box.
     std::vector<Particle>& particles;   //!< A reference to the particle list.
     CellList& cells;                    //!< A reference to the cell list.
 
 protected:
+    //! Gather the candidate neighbours of a particle from the surrounding cells.
+    /*! \param particle
+            The particle index.
+
+        \param candidates
+            A vector in which to store the indices of the candidates.
+
+        \return
+            The number of candidates.
+     */
+    unsigned int gatherCandidates(unsigned int, std::vector<unsigned int>&) const;
+
     unsigned int maxInteractions;       //!< The maximum number of interactions per particle.
     double interactionEnergy;           //!< Interaction energy scale (in units of kBT).
     double interactionRange;            //!< Size of interaction range (in units of particle diameter).
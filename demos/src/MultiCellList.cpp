@@ -0,0 +1,203 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "MultiCellList.h"
+#include "Particle.h"
+
+MultiCellList::MultiCellList() : dimension(3)
+{
+}
+
+void MultiCellList::setDimension(unsigned int dimension_)
+{
+    dimension = dimension_;
+}
+
+void MultiCellList::initialise(const std::vector<double>& boxSize,
+    const std::vector<Particle>& particles, double interactionRange, double sizeRatio)
+{
+    if (sizeRatio <= 1)
+    {
+        std::cerr << "[ERROR] MultiCellList: Size ratio must be greater than one!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Find the smallest radius.
+    double minRadius = particles[0].radius;
+    for (unsigned int i=1;i<particles.size();i++)
+        minRadius = std::min(minRadius, particles[i].radius);
+
+    if (minRadius <= 0)
+    {
+        std::cerr << "[ERROR] MultiCellList: Particle radii must be positive!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Work out the size class of each particle.
+    std::vector<unsigned int> classes(particles.size());
+    unsigned int nClasses = 0;
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        classes[i] = (unsigned int) std::floor(std::log(particles[i].radius/minRadius)/std::log(sizeRatio) + 1e-10);
+        nClasses = std::max(nClasses, classes[i] + 1);
+    }
+
+    // Map occupied size classes to levels.
+    std::vector<unsigned int> classLevels(nClasses, nClasses);
+    for (unsigned int i=0;i<particles.size();i++)
+        classLevels[classes[i]] = 0;
+
+    unsigned int nLevels = 0;
+    for (unsigned int i=0;i<nClasses;i++)
+    {
+        if (classLevels[i] == 0)
+        {
+            classLevels[i] = nLevels;
+            nLevels++;
+        }
+    }
+
+    // Largest and smallest radius in each level.
+    levels.resize(particles.size());
+    maxRadii.assign(nLevels, 0);
+    std::vector<double> minRadii(nLevels, INFINITY);
+
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        levels[i] = classLevels[classes[i]];
+        maxRadii[levels[i]] = std::max(maxRadii[levels[i]], particles[i].radius);
+        minRadii[levels[i]] = std::min(minRadii[levels[i]], particles[i].radius);
+    }
+
+    // Initialise a cell list for each level.
+    resize(nLevels);
+    for (unsigned int i=0;i<nLevels;i++)
+    {
+        at(i).setDimension(dimension);
+        at(i).initialise(boxSize, 2*interactionRange*maxRadii[i], 2*minRadii[i]);
+    }
+}
+
+void MultiCellList::initCell(Particle& particle)
+{
+    CellList& cells = at(levels[particle.index]);
+    cells.initCell(cells.getCell(particle), particle);
+}
+
+void MultiCellList::initCellList(std::vector<Particle>& particles)
+{
+    for (unsigned int i=0;i<size();i++) at(i).reset();
+
+    for (unsigned int i=0;i<particles.size();i++)
+        initCell(particles[i]);
+}
+
+void MultiCellList::updateCell(Particle& particle, std::vector<Particle>& particles)
+{
+    CellList& cells = at(levels[particle.index]);
+
+    // Calculate the particle's cell index.
+    unsigned int newCell = cells.getCell(particle);
+
+    // Update cell list if necessary.
+    if (particle.cell != newCell)
+        cells.updateCell(newCell, particle, particles);
+}
+
+bool MultiCellList::isValidBox(const std::vector<double>& boxSize) const
+{
+    for (unsigned int i=0;i<size();i++)
+    {
+        if (!at(i).isValidBox(boxSize)) return false;
+    }
+
+    return true;
+}
+
+bool MultiCellList::rescale(const std::vector<double>& boxSize, std::vector<Particle>& particles)
+{
+    bool isRebuild = false;
+
+    for (unsigned int i=0;i<size();i++)
+        isRebuild |= at(i).rescale(boxSize, particles);
+
+    return isRebuild;
+}
+
+unsigned int MultiCellList::getLevel(unsigned int particle) const
+{
+    return levels[particle];
+}
+
+double MultiCellList::getMaxRadius(unsigned int level) const
+{
+    return maxRadii[level];
+}
+
+unsigned int MultiCellList::computeCells(unsigned int level, const double* position,
+    double cutOff, std::vector<unsigned int>& cellList) const
+{
+    const std::vector<unsigned int>& cellsPerAxis = at(level).getCellsPerAxis();
+    const std::vector<double>& cellSpacing = at(level).getCellSpacing();
+
+    // Range of cell indices along each axis.
+    int start[3] = {0, 0, 0};
+    int end[3] = {0, 0, 0};
+
+    for (unsigned int i=0;i<dimension;i++)
+    {
+        start[i] = int(std::floor((position[i] - cutOff)/cellSpacing[i]));
+        end[i] = int(std::floor((position[i] + cutOff)/cellSpacing[i]));
+
+        // The stencil spans the entire box.
+        if ((end[i] - start[i] + 1) >= int(cellsPerAxis[i]))
+        {
+            start[i] = 0;
+            end[i] = cellsPerAxis[i] - 1;
+        }
+    }
+
+    int nx = cellsPerAxis[0];
+    int ny = cellsPerAxis[1];
+    int nz = (dimension == 3) ? cellsPerAxis[2] : 1;
+
+    cellList.clear();
+
+    for (int i=start[0];i<=end[0];i++)
+    {
+        int x = ((i % nx) + nx) % nx;
+
+        for (int j=start[1];j<=end[1];j++)
+        {
+            int y = ((j % ny) + ny) % ny;
+
+            for (int k=start[2];k<=end[2];k++)
+            {
+                int z = ((k % nz) + nz) % nz;
+
+                cellList.push_back(x + nx*y + nx*ny*z);
+            }
+        }
+    }
+
+    return cellList.size();
+}
@@ -0,0 +1,154 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MULTICELLLIST_H
+#define _MULTICELLLIST_H
+
+#include "CellList.h"
+
+/*! \file MultiCellList.h
+    \brief A hierarchy of cell lists for polydisperse systems.
+
+    With a single cell list, the cell spacing must be set by the interaction
+    range of the largest particles, so searching for the neighbours of a
+    small particle scans many small particles that are well out of range.
+    Instead, particles are grouped into size classes, with radii spanning
+    a fixed ratio, and each class is stored in its own cell list with a
+    spacing set by the largest particles in the class.
+
+    Neighbours are found by visiting every level in turn. The stencil on each
+    level is the block of cells overlapping the cut-off sphere for the pair,
+    i.e. the sum of the radius of the particle and the largest radius in the
+    level, scaled by the interaction range. A large particle therefore visits
+    many small cells on a fine level, whereas a small particle only visits the
+    one or two cells that surround it on a coarse level, so the cost of a
+    search remains proportional to the number of particles within range.
+*/
+
+//! Container class for storing a hierarchy of cell lists, one per size class.
+class MultiCellList : public std::vector<CellList>
+{
+public:
+    //! Default constructor.
+    MultiCellList();
+
+    //! Set the dimensionality of the cell lists.
+    /*! \param dimension_
+            The dimensionality of the simulation.
+     */
+    void setDimension(unsigned int);
+
+    //! Assign particles to size classes and initialise a cell list for each.
+    /*! \param boxSize
+            The size of the simulation box in each dimension.
+
+        \param particles
+            Reference to a vector of particles (only the radii are used).
+
+        \param interactionRange
+            The interaction range (in units of the contact distance).
+
+        \param sizeRatio
+            The ratio of the largest to smallest radius in each size class.
+     */
+    void initialise(const std::vector<double>&, const std::vector<Particle>&, double, double sizeRatio = 2.0);
+
+    //! Insert a particle into the cell list for its size class.
+    /*! \param particle
+            Reference to a particle.
+     */
+    void initCell(Particle&);
+
+    //! Insert all particles into the cell lists.
+    /*! \param particles
+            Reference to a vector of particles.
+     */
+    void initCellList(std::vector<Particle>&);
+
+    //! Update the cell list for a particle following a move.
+    /*! \param particle
+            Reference to a particle.
+
+        \param particles
+            Reference to a vector of particles.
+     */
+    void updateCell(Particle&, std::vector<Particle>&);
+
+    //! Check whether a box is large enough for every cell list.
+    /*! \param boxSize
+            The size of the simulation box in each dimension.
+
+        \return
+            Whether each cell list has at least three cells along each axis.
+     */
+    bool isValidBox(const std::vector<double>&) const;
+
+    //! Rescale all cell lists following a change in the box size.
+    /*! \param boxSize
+            The new size of the simulation box in each dimension.
+
+        \param particles
+            Reference to a vector of particles (already in the rescaled box).
+
+        \return
+            Whether any cell list was rebuilt.
+     */
+    bool rescale(const std::vector<double>&, std::vector<Particle>&);
+
+    //! Get the size class of a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            The level of the cell list containing the particle.
+     */
+    unsigned int getLevel(unsigned int) const;
+
+    //! Get the largest particle radius in a size class.
+    /*! \param level
+            The level index.
+
+        \return
+            The largest radius.
+     */
+    double getMaxRadius(unsigned int) const;
+
+    //! Find the cells on a level that overlap a sphere.
+    /*! \param level
+            The level index.
+
+        \param position
+            The centre of the sphere.
+
+        \param cutOff
+            The radius of the sphere.
+
+        \param cellList
+            A vector in which to store the cell indices.
+
+        \return
+            The number of cells.
+     */
+    unsigned int computeCells(unsigned int, const double*, double, std::vector<unsigned int>&) const;
+
+private:
+    unsigned int dimension;                 //!< Dimension of the simulation box.
+    std::vector<unsigned int> levels;       //!< The size class of each particle.
+    std::vector<double> maxRadii;           //!< The largest radius in each size class.
+};
+
+#endif  /* _MULTICELLLIST_H */
@@ -17,6 +17,6 @@
 
 #include "Particle.h"
 
-Particle::Particle()
+Particle::Particle() : radius(0.5), type(0)
 {
 }
@@ -34,6 +34,8 @@ public:
     unsigned int index;                 //!< Particle index.
     std::vector<double> position;       //!< The x,y,z coordinates of the particle.
     std::vector<double> orientation;    //!< The orientation of the particle (unit vector).
+    double radius;                      //!< The radius of the particle (one half by default).
+    unsigned int type;                  //!< The species of the particle (zero by default).
 
     unsigned int cell;                  //!< The index of the cell in which the particle is located.
     unsigned int posCell;               //!< Position of particle in the corresponding cell list.
@@ -0,0 +1,408 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "Box.h"
+#include "CellList.h"
+#include "Particle.h"
+#include "PatchySphere.h"
+#include "VMMC.h"
+
+PatchySphere::PatchySphere(
+    Box& box_,
+    std::vector<Particle>& particles_,
+    CellList& cells_,
+    unsigned int maxInteractions_,
+    double interactionEnergy_,
+    double interactionRange_,
+    const std::vector<std::vector<double> >& patchDirections,
+    double patchAngle) :
+    Model(box_, particles_, cells_, maxInteractions_, interactionEnergy_, interactionRange_),
+    engine(nullptr)
+{
+#ifdef ISOTROPIC
+    std::cerr << "[ERROR] PatchySphere: Cannot be used with isotropic VMMC library!\n";
+    exit(EXIT_FAILURE);
+#endif
+
+    // Check dimensionality.
+    if (box.dimension != 3)
+    {
+        std::cerr << "[ERROR] PatchySphere: Model only valid in three dimensions!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    nPatches = patchDirections.size();
+
+    if (nPatches == 0)
+    {
+        std::cerr << "[ERROR] PatchySphere: There must be at least one patch!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    cosPatchAngle = std::cos(patchAngle);
+
+    // Store the normalised patch directions.
+    bodyPatches.resize(3*nPatches);
+    for (unsigned int i=0;i<nPatches;i++)
+    {
+        if (patchDirections[i].size() != 3)
+        {
+            std::cerr << "[ERROR] PatchySphere: Patch directions must be three dimensional!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        double norm = std::sqrt(patchDirections[i][0]*patchDirections[i][0]
+                    + patchDirections[i][1]*patchDirections[i][1]
+                    + patchDirections[i][2]*patchDirections[i][2]);
+
+        for (unsigned int j=0;j<3;j++)
+            bodyPatches[3*i + j] = patchDirections[i][j]/norm;
+    }
+
+    frames.resize(3*particles.size());
+    patches.resize(3*nPatches*particles.size());
+    trialPatches.resize(6*nPatches);
+}
+
+void PatchySphere::initialisePatches()
+{
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        const double* u = &particles[i].orientation[0];
+
+        // Cross the orientation with the axis it is least aligned with.
+        unsigned int axis = 0;
+        for (unsigned int j=1;j<3;j++)
+            if (std::abs(u[j]) < std::abs(u[axis])) axis = j;
+
+        double a[3] = {0, 0, 0};
+        a[axis] = 1;
+
+        double* e = &frames[3*i];
+        e[0] = u[1]*a[2] - u[2]*a[1];
+        e[1] = u[2]*a[0] - u[0]*a[2];
+        e[2] = u[0]*a[1] - u[1]*a[0];
+
+        double norm = std::sqrt(e[0]*e[0] + e[1]*e[1] + e[2]*e[2]);
+        for (unsigned int j=0;j<3;j++) e[j] /= norm;
+
+        computePatchVectors(u, e, &patches[3*nPatches*i]);
+    }
+}
+
+double PatchySphere::computeEnergy(unsigned int particle, const double* position, const double* orientation)
+{
+    // Energy counter.
+    double energy = 0;
+
+    // Patch vectors for the trial orientation (computed once).
+    const double* patches1 = computePatches(particle, orientation, &trialPatches[0]);
+
+    // Check all neighbouring cells including same cell.
+    for (unsigned int i=0;i<cells.getNeighbours();i++)
+    {
+        // Cell index.
+        unsigned int cell = cells[particles[particle].cell].neighbours[i];
+
+        // Check all particles within cell.
+        for (unsigned int j=0;j<cells[cell].tally;j++)
+        {
+            // Index of neighbouring particle.
+            unsigned int neighbour = cells[cell].particles[j];
+
+            // Make sure the particles are different.
+            if (neighbour != particle)
+            {
+                double sep[3];
+                double normSqd = computeSeparation(position, &particles[neighbour].position[0], sep);
+
+                // Centre-centre pre-filter.
+                if (normSqd < squaredCutOffDistance)
+                {
+                    // Particles overlap.
+                    if (normSqd < 1) return INF;
+
+                    energy += computePatchEnergy(sep, normSqd, patches1, &patches[3*nPatches*neighbour]);
+                }
+            }
+        }
+    }
+
+    return energy;
+}
+
+double PatchySphere::computePairEnergy(unsigned int particle1, const double* position1,
+    const double* orientation1, unsigned int particle2, const double* position2, const double* orientation2)
+{
+    double sep[3];
+    double normSqd = computeSeparation(position1, position2, sep);
+
+    // Centre-centre pre-filter.
+    if (normSqd >= squaredCutOffDistance) return 0;
+
+    // Particles overlap.
+    if (normSqd < 1) return INF;
+
+    const double* patches1 = computePatches(particle1, orientation1, &trialPatches[0]);
+    const double* patches2 = computePatches(particle2, orientation2, &trialPatches[3*nPatches]);
+
+    return computePatchEnergy(sep, normSqd, patches1, patches2);
+}
+
+unsigned int PatchySphere::computeInteractions(unsigned int particle,
+    const double* position, const double* orientation, unsigned int* interactions)
+{
+    // Interaction counter.
+    unsigned int nInteractions = 0;
+
+    // Patch vectors for the trial orientation (computed once).
+    const double* patches1 = computePatches(particle, orientation, &trialPatches[0]);
+
+    // Check all neighbouring cells including same cell.
+    for (unsigned int i=0;i<cells.getNeighbours();i++)
+    {
+        // Cell index.
+        unsigned int cell = cells[particles[particle].cell].neighbours[i];
+
+        // Check all particles within cell.
+        for (unsigned int j=0;j<cells[cell].tally;j++)
+        {
+            // Index of neighbouring particle.
+            unsigned int neighbour = cells[cell].particles[j];
+
+            // Make sure the particles are different.
+            if (neighbour != particle)
+            {
+                double sep[3];
+                double normSqd = computeSeparation(position, &particles[neighbour].position[0], sep);
+
+                // Centre-centre pre-filter (overlapping particles don't interact).
+                if ((normSqd < squaredCutOffDistance) && (normSqd >= 1))
+                {
+                    // Particles interact.
+                    if (computePatchEnergy(sep, normSqd, patches1, &patches[3*nPatches*neighbour]) < 0)
+                    {
+                        if (nInteractions == maxInteractions)
+                        {
+                            std::cerr << "[ERROR] PatchySphere: Maximum number of interactions exceeded!\n";
+                            exit(EXIT_FAILURE);
+                        }
+
+                        interactions[nInteractions] = neighbour;
+                        nInteractions++;
+                    }
+                }
+            }
+        }
+    }
+
+    return nInteractions;
+}
+
+void PatchySphere::applyPostMoveUpdates(unsigned int particle, const double* position, const double* orientation)
+{
+    // Carry the body frame to the new orientation and update the cached patches.
+    double frame[3];
+    rotateFrame(particle, orientation, frame);
+
+    for (unsigned int i=0;i<3;i++)
+        frames[3*particle + i] = frame[i];
+
+    computePatchVectors(orientation, frame, &patches[3*nPatches*particle]);
+
+    // Copy coordinates/orientations and update the cell list.
+#ifndef ISOTROPIC
+    Model::applyPostMoveUpdates(particle, position, orientation);
+#else
+    Model::applyPostMoveUpdates(particle, position);
+#endif
+}
+
+const double* PatchySphere::getPatches(unsigned int particle) const
+{
+    return &patches[3*nPatches*particle];
+}
+
+unsigned int PatchySphere::getNumPatches() const
+{
+    return nPatches;
+}
+
+void PatchySphere::setEngine(const vmmc::VMMC& engine_)
+{
+    engine = &engine_;
+}
+
+const double* PatchySphere::computePatches(unsigned int particle, const double* orientation, double* patchVectors)
+{
+    const double* u = &particles[particle].orientation[0];
+
+    // Orientation is unchanged, use the cache.
+    if ((orientation[0] == u[0]) && (orientation[1] == u[1]) && (orientation[2] == u[2]))
+        return &patches[3*nPatches*particle];
+
+    double frame[3];
+    rotateFrame(particle, orientation, frame);
+    computePatchVectors(orientation, frame, patchVectors);
+
+    return patchVectors;
+}
+
+void PatchySphere::rotateFrame(unsigned int particle, const double* orientation, double* frame) const
+{
+    const double* u = &particles[particle].orientation[0];
+    const double* e = &frames[3*particle];
+
+    // Axis of the current cluster rotation (if any).
+    const double* n = (engine == nullptr) ? nullptr : engine->getRotationAxis();
+
+    // Carry the frame rigidly with the cluster rotation. The angle is recovered from
+    // the components of the old and new orientations perpendicular to the axis.
+    if (n != nullptr)
+    {
+        double uDotN = u[0]*n[0] + u[1]*n[1] + u[2]*n[2];
+        double vDotN = orientation[0]*n[0] + orientation[1]*n[1] + orientation[2]*n[2];
+
+        double p[3], q[3];
+        for (unsigned int i=0;i<3;i++)
+        {
+            p[i] = u[i] - uDotN*n[i];
+            q[i] = orientation[i] - vDotN*n[i];
+        }
+
+        double pSqd = p[0]*p[0] + p[1]*p[1] + p[2]*p[2];
+
+        // The orientation must be a rotation about the axis, and not (numerically) parallel to it.
+        if ((std::abs(uDotN - vDotN) < 1e-9) && (pSqd > 1e-12))
+        {
+            double cosAngle = p[0]*q[0] + p[1]*q[1] + p[2]*q[2];
+            double sinAngle = n[0]*(p[1]*q[2] - p[2]*q[1])
+                            + n[1]*(p[2]*q[0] - p[0]*q[2])
+                            + n[2]*(p[0]*q[1] - p[1]*q[0]);
+
+            double angle = std::atan2(sinAngle, cosAngle);
+            double c = std::cos(angle);
+            double s = std::sin(angle);
+
+            // Rodrigues' formula for the rotation of the frame about the axis.
+            double nDotE = (n[0]*e[0] + n[1]*e[1] + n[2]*e[2])*(1.0 - c);
+
+            frame[0] = c*e[0] + s*(n[1]*e[2] - n[2]*e[1]) + nDotE*n[0];
+            frame[1] = c*e[1] + s*(n[2]*e[0] - n[0]*e[2]) + nDotE*n[1];
+            frame[2] = c*e[2] + s*(n[0]*e[1] - n[1]*e[0]) + nDotE*n[2];
+
+            orthonormalise(orientation, frame);
+            return;
+        }
+    }
+
+    // Otherwise, e.g. a random reorientation, use the minimal rotation taking u to the new orientation.
+    double c = u[0]*orientation[0] + u[1]*orientation[1] + u[2]*orientation[2];
+    double v[3] = {u[1]*orientation[2] - u[2]*orientation[1],
+                   u[2]*orientation[0] - u[0]*orientation[2],
+                   u[0]*orientation[1] - u[1]*orientation[0]};
+
+    if (c > -1.0 + 1e-12)
+    {
+        // Rodrigues' formula for the minimal rotation.
+        double vDotE = v[0]*e[0] + v[1]*e[1] + v[2]*e[2];
+        double scale = vDotE/(1.0 + c);
+
+        frame[0] = c*e[0] + (v[1]*e[2] - v[2]*e[1]) + scale*v[0];
+        frame[1] = c*e[1] + (v[2]*e[0] - v[0]*e[2]) + scale*v[1];
+        frame[2] = c*e[2] + (v[0]*e[1] - v[1]*e[0]) + scale*v[2];
+    }
+    else
+    {
+        // Antiparallel: rotate by pi about the body x axis, which leaves it unchanged.
+        frame[0] = e[0];
+        frame[1] = e[1];
+        frame[2] = e[2];
+    }
+
+    orthonormalise(orientation, frame);
+}
+
+void PatchySphere::orthonormalise(const double* orientation, double* frame) const
+{
+    // Remove any drift out of the plane perpendicular to the orientation.
+    double dot = frame[0]*orientation[0] + frame[1]*orientation[1] + frame[2]*orientation[2];
+    for (unsigned int i=0;i<3;i++) frame[i] -= dot*orientation[i];
+
+    double norm = std::sqrt(frame[0]*frame[0] + frame[1]*frame[1] + frame[2]*frame[2]);
+    for (unsigned int i=0;i<3;i++) frame[i] /= norm;
+}
+
+void PatchySphere::computePatchVectors(const double* orientation, const double* frame, double* patchVectors) const
+{
+    // Body y axis.
+    double y[3] = {orientation[1]*frame[2] - orientation[2]*frame[1],
+                   orientation[2]*frame[0] - orientation[0]*frame[2],
+                   orientation[0]*frame[1] - orientation[1]*frame[0]};
+
+    // Store the x, y, and z components in separate blocks.
+    for (unsigned int i=0;i<nPatches;i++)
+    {
+        const double* b = &bodyPatches[3*i];
+
+        for (unsigned int j=0;j<3;j++)
+            patchVectors[j*nPatches + i] = b[0]*frame[j] + b[1]*y[j] + b[2]*orientation[j];
+    }
+}
+
+double PatchySphere::computeSeparation(const double* position1, const double* position2, double* sep) const
+{
+    return box.computeSeparation(position1, position2, sep);
+}
+
+double PatchySphere::computePatchEnergy(const double* sep, double normSqd,
+    const double* patches1, const double* patches2) const
+{
+    // Patches must lie within the half-angle of the separation vector,
+    // i.e. p.r >= |r| cos(delta).
+    double threshold = std::sqrt(normSqd)*cosPatchAngle;
+
+    const double* x1 = patches1;
+    const double* y1 = patches1 + nPatches;
+    const double* z1 = patches1 + 2*nPatches;
+    const double* x2 = patches2;
+    const double* y2 = patches2 + nPatches;
+    const double* z2 = patches2 + 2*nPatches;
+
+    double sx = sep[0];
+    double sy = sep[1];
+    double sz = sep[2];
+
+    // Count the patches on each particle that face the other. The loop is branch
+    // free, with floating point counters, so that it vectorises.
+    double n1 = 0;
+    double n2 = 0;
+    for (unsigned int i=0;i<nPatches;i++)
+    {
+        double dot1 = x1[i]*sx + y1[i]*sy + z1[i]*sz;
+        double dot2 = x2[i]*sx + y2[i]*sy + z2[i]*sz;
+
+        n1 += (dot1 >= threshold) ? 1.0 : 0.0;
+        n2 += (dot2 <= -threshold) ? 1.0 : 0.0;
+    }
+
+    return -interactionEnergy*n1*n2;
+}
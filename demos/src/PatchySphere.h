@@ -0,0 +1,279 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PATCHYSPHERE_H
+#define _PATCHYSPHERE_H
+
+#include "Model.h"
+
+namespace vmmc
+{
+    class VMMC;
+}
+
+/*! \file PatchySphere.h
+    \brief The three dimensional Kern-Frenkel patchy sphere potential.
+
+    Hard spheres of unit diameter carry a set of circular patches. A pair
+    of particles separated by r, where r < interactionRange, gains an energy
+    of -interactionEnergy for every pair of patches, one on each particle,
+    that point towards the other particle to within the patch half-angle.
+
+    VMMC only stores a single orientation vector per particle, which can't
+    describe the orientation of a particle with an arbitrary arrangement of
+    patches. Each particle therefore carries a body frame: the orientation
+    vector is the body z axis and the model stores the body x axis. During
+    a cluster rotation the x axis is rotated rigidly about the axis of the
+    move, which the model reads from the engine (see setEngine), so the
+    patches of every particle in the cluster turn together. Any other
+    change of orientation, e.g. a random reorientation, carries the x axis
+    along by the minimal rotation that takes the old orientation vector to
+    the new one. Both are deterministic maps whose inverse is the reverse
+    move, so detailed balance is unaffected. Without an engine, e.g. for
+    patch layouts that are symmetric about the orientation vector, the
+    minimal rotation is always used.
+
+    The world frame patch vectors of each particle are cached, with the x,
+    y, and z components stored in separate blocks, and are only recomputed
+    in applyPostMoveUpdates, i.e. once per particle per accepted move.
+    Patch vectors for trial orientations are computed once per call. When
+    evaluating a pair, the centre-centre separation is tested first, then
+    the hard core, and the patch dot products are only evaluated for
+    non-overlapping pairs within range.
+
+    Since the model stores per-particle state, the callbacks must be bound
+    to a pointer to the model, rather than to a copy of it. Call
+    initialisePatches once the particle orientations have been set, and
+    setEngine once the VMMC object has been constructed.
+*/
+
+//! Class defining the Kern-Frenkel patchy sphere potential.
+class PatchySphere : public Model
+{
+public:
+    //! Constructor.
+    /*! \param box_
+            A reference to the simulation box object.
+
+        \param particles_
+            A reference to the particle list.
+
+        \param cells_
+            A reference to the cell list object.
+
+        \param maxInteractions_
+            The maximum number of interactions per particle.
+
+        \param interactionEnergy_
+            The patch-patch interaction energy (in units of kBT).
+
+        \param interactionRange_
+            The centre-centre interaction range (in units of particle diameter).
+
+        \param patchDirections
+            The direction of each patch in the body frame (the body z axis
+            is the particle's orientation vector).
+
+        \param patchAngle
+            The half-angle of each patch (in radians).
+     */
+    PatchySphere(Box&, std::vector<Particle>&, CellList&, unsigned int, double, double,
+        const std::vector<std::vector<double> >&, double);
+
+    //! Initialise the body frames and patch vectors from the particle orientations.
+    void initialisePatches();
+
+    //! Calculate the total interaction energy felt by a particle.
+    /*! \param index
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the first particle.
+
+        \return
+            The total interaction energy.
+     */
+    double computeEnergy(unsigned int, const double*, const double*);
+
+    //! Calculate the pair energy between two particles.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param position1
+            The position vector of the first particle.
+
+        \param orientation1
+            The orientation vector of the first particle.
+
+        \param particle2
+            The index of the second particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \param orientation2
+            The orientation vector of the second particle.
+
+        \return
+            The pair energy between particles 1 and 2.
+     */
+    double computePairEnergy(unsigned int, const double*, const double*, unsigned int, const double*, const double*);
+
+    //! Determine the interactions for a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the particle.
+
+        \param interactions
+            An array to store the indices of neighbours with which the particle interacts.
+
+        \return
+            The number of interactions.
+     */
+    unsigned int computeInteractions(unsigned int, const double*, const double*, unsigned int*);
+
+    //! Apply any post-move updates for a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position of the particle following the virtual move.
+
+        \param orientation
+            The orientation of the particle following the virtual move.
+    */
+    void applyPostMoveUpdates(unsigned int, const double*, const double*);
+
+    //! Get the world frame patch vectors of a particle.
+    /*! \param particle
+            The particle index.
+
+        \return
+            A pointer to the x components of the patch vectors, followed
+            by the y components, then the z components.
+     */
+    const double* getPatches(unsigned int) const;
+
+    //! Get the number of patches per particle.
+    unsigned int getNumPatches() const;
+
+    //! Set the engine whose cluster rotations the body frames follow.
+    /*! \param engine_
+            A reference to the VMMC object, which must outlive the model's use of it.
+     */
+    void setEngine(const vmmc::VMMC&);
+
+private:
+    unsigned int nPatches;              //!< The number of patches per particle.
+    double cosPatchAngle;               //!< The cosine of the patch half-angle.
+    std::vector<double> bodyPatches;    //!< The patch directions in the body frame.
+    std::vector<double> frames;         //!< The body x axis of each particle.
+    std::vector<double> patches;        //!< The cached world frame patch vectors of each particle.
+    std::vector<double> trialPatches;   //!< Work space for the patch vectors of trial orientations.
+    const vmmc::VMMC* engine;           //!< The engine, for the axis of cluster rotations (optional).
+
+    //! Compute the patch vectors of a particle with a given orientation.
+    /*! \param particle
+            The particle index.
+
+        \param orientation
+            The orientation vector of the particle.
+
+        \param patchVectors
+            A pointer to an array in which to store the patch vectors (if needed).
+
+        \return
+            A pointer to the patch vectors (the cache if the orientation is unchanged).
+     */
+    const double* computePatches(unsigned int, const double*, double*);
+
+    //! Carry the body x axis of a particle to a new orientation.
+    /*! \param particle
+            The particle index.
+
+        \param orientation
+            The new orientation vector of the particle.
+
+        \param frame
+            An array in which to store the new body x axis.
+     */
+    void rotateFrame(unsigned int, const double*, double*) const;
+
+    //! Make a body x axis a unit vector perpendicular to the orientation.
+    /*! \param orientation
+            The body z axis.
+
+        \param frame
+            The body x axis, which is modified in place.
+     */
+    void orthonormalise(const double*, double*) const;
+
+    //! Compute the world frame patch vectors from a body frame.
+    /*! \param orientation
+            The body z axis.
+
+        \param frame
+            The body x axis.
+
+        \param patchVectors
+            An array in which to store the patch vectors.
+     */
+    void computePatchVectors(const double*, const double*, double*) const;
+
+    //! Compute the minimum image separation between two particles.
+    /*! \param position1
+            The position vector of the first particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \param sep
+            An array in which to store the separation from the first to the second particle.
+
+        \return
+            The squared separation.
+     */
+    double computeSeparation(const double*, const double*, double*) const;
+
+    //! Compute the patch energy of a non-overlapping pair within range.
+    /*! \param sep
+            The minimum image separation from the first to the second particle.
+
+        \param normSqd
+            The squared separation.
+
+        \param patches1
+            The patch vectors of the first particle.
+
+        \param patches2
+            The patch vectors of the second particle.
+
+        \return
+            The pair energy.
+     */
+    double computePatchEnergy(const double*, double, const double*, const double*) const;
+};
+
+#endif  /* _PATCHYSPHERE_H */
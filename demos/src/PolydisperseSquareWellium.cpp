@@ -0,0 +1,264 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include "Box.h"
+#include "MultiCellList.h"
+#include "Particle.h"
+#include "PolydisperseSquareWellium.h"
+
+PolydisperseSquareWellium::PolydisperseSquareWellium(
+    Box& box_,
+    std::vector<Particle>& particles_,
+    MultiCellList& multiCells_,
+    unsigned int maxInteractions_,
+    double interactionEnergy_,
+    double interactionRange_) :
+    Model(box_, particles_, multiCells_[0], maxInteractions_, interactionEnergy_, interactionRange_),
+    multiCells(multiCells_)
+{
+}
+
+#ifndef ISOTROPIC
+double PolydisperseSquareWellium::computeEnergy(unsigned int particle, const double* position, const double* orientation)
+#else
+double PolydisperseSquareWellium::computeEnergy(unsigned int particle, const double* position)
+#endif
+{
+    // Energy counter.
+    double energy = 0;
+
+    // Check all levels.
+    for (unsigned int i=0;i<multiCells.size();i++)
+    {
+        double cutOff = interactionRange*(particles[particle].radius + multiCells.getMaxRadius(i));
+        unsigned int nCells = multiCells.computeCells(i, position, cutOff, cellList);
+
+        const CellList& cells = multiCells[i];
+
+        for (unsigned int j=0;j<nCells;j++)
+        {
+            unsigned int cell = cellList[j];
+
+            // Check all particles within cell.
+            for (unsigned int k=0;k<cells[cell].tally;k++)
+            {
+                // Index of neighbouring particle.
+                unsigned int neighbour = cells[cell].particles[k];
+
+                // Make sure the particles are different.
+                if (neighbour != particle)
+                {
+#ifndef ISOTROPIC
+                    energy += computePairEnergy(particle, position, orientation,
+                              neighbour, &particles[neighbour].position[0],
+                              &particles[neighbour].orientation[0]);
+#else
+                    energy += computePairEnergy(particle, position,
+                              neighbour, &particles[neighbour].position[0]);
+#endif
+
+                    // Early exit test for hard core overlaps.
+                    if (energy > 1e6) return INF;
+                }
+            }
+        }
+    }
+
+    return energy;
+}
+
+#ifndef ISOTROPIC
+double PolydisperseSquareWellium::computePairEnergy(unsigned int particle1, const double* position1,
+    const double* orientation1, unsigned int particle2, const double* position2, const double* orientation2)
+#else
+double PolydisperseSquareWellium::computePairEnergy(unsigned int particle1,
+    const double* position1, unsigned int particle2, const double* position2)
+#endif
+{
+    double normSqd = computeSeparation(position1, position2);
+
+    // Contact distance.
+    double sigma = particles[particle1].radius + particles[particle2].radius;
+
+    if (normSqd < sigma*sigma) return INF;
+    if (normSqd < squaredCutOffDistance*sigma*sigma) return -interactionEnergy;
+    return 0;
+}
+
+#ifndef ISOTROPIC
+unsigned int PolydisperseSquareWellium::computeInteractions(unsigned int particle,
+    const double* position, const double* orientation, unsigned int* interactions)
+#else
+unsigned int PolydisperseSquareWellium::computeInteractions(unsigned int particle,
+    const double* position, unsigned int* interactions)
+#endif
+{
+    // Interaction counter.
+    unsigned int nInteractions = 0;
+
+    // Check all levels.
+    for (unsigned int i=0;i<multiCells.size();i++)
+    {
+        double cutOff = interactionRange*(particles[particle].radius + multiCells.getMaxRadius(i));
+        unsigned int nCells = multiCells.computeCells(i, position, cutOff, cellList);
+
+        const CellList& cells = multiCells[i];
+
+        for (unsigned int j=0;j<nCells;j++)
+        {
+            unsigned int cell = cellList[j];
+
+            // Check all particles within cell.
+            for (unsigned int k=0;k<cells[cell].tally;k++)
+            {
+                // Index of neighbouring particle.
+                unsigned int neighbour = cells[cell].particles[k];
+
+                // Make sure the particles are different.
+                if (neighbour != particle)
+                {
+                    double normSqd = computeSeparation(position, &particles[neighbour].position[0]);
+
+                    // Contact distance.
+                    double sigma = particles[particle].radius + particles[neighbour].radius;
+
+                    // Particles interact.
+                    if (normSqd < squaredCutOffDistance*sigma*sigma)
+                    {
+                        if (nInteractions == maxInteractions)
+                        {
+                            std::cerr << "[ERROR] PolydisperseSquareWellium: Maximum number of interactions exceeded!\n";
+                            exit(EXIT_FAILURE);
+                        }
+
+                        interactions[nInteractions] = neighbour;
+                        nInteractions++;
+                    }
+                }
+            }
+        }
+    }
+
+    return nInteractions;
+}
+
+unsigned int PolydisperseSquareWellium::computeNeighbours(unsigned int particle,
+    double distance, unsigned int* neighbours)
+{
+    // Neighbour counter.
+    unsigned int nNeighbours = 0;
+
+    // Check all levels.
+    for (unsigned int i=0;i<multiCells.size();i++)
+    {
+        unsigned int nCells = multiCells.computeCells(i, &particles[particle].position[0], distance, cellList);
+
+        const CellList& cells = multiCells[i];
+
+        for (unsigned int j=0;j<nCells;j++)
+        {
+            unsigned int cell = cellList[j];
+
+            // Check all particles within cell.
+            for (unsigned int k=0;k<cells[cell].tally;k++)
+            {
+                // Index of neighbouring particle.
+                unsigned int neighbour = cells[cell].particles[k];
+
+                // Make sure the particles are different.
+                if (neighbour != particle)
+                {
+                    neighbours[nNeighbours] = neighbour;
+                    nNeighbours++;
+                }
+            }
+        }
+    }
+
+    return nNeighbours;
+}
+
+#ifndef ISOTROPIC
+void PolydisperseSquareWellium::applyPostMoveUpdates(unsigned int particle, const double* position, const double* orientation)
+#else
+void PolydisperseSquareWellium::applyPostMoveUpdates(unsigned int particle, const double* position)
+#endif
+{
+    // Copy coordinates/orientations.
+    for (unsigned int i=0;i<box.dimension;i++)
+    {
+        particles[particle].position[i] = position[i];
+#ifndef ISOTROPIC
+        particles[particle].orientation[i] = orientation[i];
+#endif
+    }
+
+    // Update the cell list for the particle's size class.
+    multiCells.updateCell(particles[particle], particles);
+}
+
+bool PolydisperseSquareWellium::setBoxSize(const double* boxSize)
+{
+    std::vector<double> newBoxSize(boxSize, boxSize + box.dimension);
+
+    // The box is too small for the cell list.
+    if (!multiCells.isValidBox(newBoxSize)) return false;
+
+    // Affinely rescale particle positions.
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        for (unsigned int j=0;j<box.dimension;j++)
+        {
+            particles[i].position[j] *= newBoxSize[j]/box.boxSize[j];
+
+            // Guard against rounding at the box boundary.
+            if (particles[i].position[j] >= newBoxSize[j]) particles[i].position[j] = 0;
+        }
+    }
+
+    // Update the simulation box.
+    box.setSize(newBoxSize);
+
+    // Update the cell lists, rebuilding if necessary.
+    multiCells.rescale(newBoxSize, particles);
+
+    return true;
+}
+
+double PolydisperseSquareWellium::computeSeparation(const double* position1, const double* position2)
+{
+    // Separation vector.
+    std::vector<double> sep(box.dimension);
+
+    // Calculate separation.
+    for (unsigned int i=0;i<box.dimension;i++)
+        sep[i] = position1[i] - position2[i];
+
+    // Enforce minimum image.
+    box.minimumImage(sep);
+
+    double normSqd = 0;
+
+    // Calculate squared norm of vector.
+    for (unsigned int i=0;i<box.dimension;i++)
+        normSqd += sep[i]*sep[i];
+
+    return normSqd;
+}
@@ -0,0 +1,188 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _POLYDISPERSESQUAREWELLIUM_H
+#define _POLYDISPERSESQUAREWELLIUM_H
+
+#include "Model.h"
+
+/*! \file PolydisperseSquareWellium.h
+    \brief A square-well potential for particles of different sizes.
+
+    Particles i and j have a hard core at the contact distance
+    sigma_ij = r_i + r_j and an attractive well extending to
+    interactionRange * sigma_ij. Neighbours are found using a MultiCellList,
+    so the cost of a neighbour search doesn't depend on the size of the
+    largest particle.
+*/
+
+// FORWARD DECLARATIONS
+
+class MultiCellList;
+
+//! Class defining the square-well potential for polydisperse particles.
+class PolydisperseSquareWellium : public Model
+{
+public:
+    //! Constructor.
+    /*! \param box_
+            A reference to the simulation box object.
+
+        \param particles_
+            A reference to the particle list.
+
+        \param multiCells_
+            A reference to the multi-level cell list object.
+
+        \param maxInteractions_
+            The maximum number of interactions per particle.
+
+        \param interactionEnergy_
+            The square well interaction energy (in units of kBT).
+
+        \param interactionRange_
+            The square well interaction range (in units of the contact distance).
+     */
+    PolydisperseSquareWellium(Box&, std::vector<Particle>&, MultiCellList&, unsigned int, double, double);
+
+    //! Calculate the total interaction energy felt by a particle.
+    /*! \param index
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the first particle.
+
+        \return
+            The total interaction energy.
+     */
+#ifndef ISOTROPIC
+    double computeEnergy(unsigned int, const double*, const double*);
+#else
+    double computeEnergy(unsigned int, const double*);
+#endif
+
+    //! Calculate the pair energy between two particles.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param position1
+            The position vector of the first particle.
+
+        \param orientation1
+            The orientation vector of the first particle.
+
+        \param particle2
+            The index of the second particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \param orientation2
+            The orientation vector of the second particle.
+
+        \return
+            The pair energy between particles 1 and 2.
+     */
+#ifndef ISOTROPIC
+    double computePairEnergy(unsigned int, const double*, const double*, unsigned int, const double*, const double*);
+#else
+    double computePairEnergy(unsigned int, const double*, unsigned int, const double*);
+#endif
+
+    //! Determine the interactions for a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the particle.
+
+        \param interactions
+            An array to store the indices of neighbours with which the particle interacts.
+
+        \return
+            The number of interactions.
+     */
+#ifndef ISOTROPIC
+    unsigned int computeInteractions(unsigned int, const double*, const double*, unsigned int*);
+#else
+    unsigned int computeInteractions(unsigned int, const double*, unsigned int*);
+#endif
+
+    //! Apply any post-move updates for a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position of the particle following the virtual move.
+
+        \param orientation
+            The orientation of the particle following the virtual move.
+    */
+#ifndef ISOTROPIC
+    void applyPostMoveUpdates(unsigned int, const double*, const double*);
+#else
+    void applyPostMoveUpdates(unsigned int, const double*);
+#endif
+
+    //! Find the particles close to a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param distance
+            The search distance.
+
+        \param neighbours
+            An array to store the indices of the neighbouring particles.
+
+        \return
+            The number of neighbours.
+     */
+    unsigned int computeNeighbours(unsigned int, double, unsigned int*);
+
+    //! Set the size of the simulation box, e.g. following a volume move.
+    /*! \param boxSize
+            The new size of the simulation box in each dimension.
+
+        \return
+            Whether the box size was updated.
+     */
+    bool setBoxSize(const double*);
+
+private:
+    MultiCellList& multiCells;          //!< A reference to the multi-level cell list.
+    std::vector<unsigned int> cellList; //!< Workspace for the cells overlapping a cut-off sphere.
+
+    //! Compute the squared separation between two particles.
+    /*! \param position1
+            The position vector of the first particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \return
+            The squared minimum image separation.
+     */
+    double computeSeparation(const double*, const double*);
+};
+
+#endif  /* _POLYDISPERSESQUAREWELLIUM_H */
@@ -0,0 +1,188 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "Box.h"
+#include "CellList.h"
+#include "InteractionTable.h"
+#include "Particle.h"
+#include "SquareWelliumMixture.h"
+
+const unsigned int SquareWelliumMixture::BLOCK_SIZE;
+
+SquareWelliumMixture::SquareWelliumMixture(
+    Box& box_,
+    std::vector<Particle>& particles_,
+    CellList& cells_,
+    const InteractionTable& table_,
+    unsigned int maxInteractions_) :
+    Model(box_, particles_, cells_, maxInteractions_, 0, table_.getMaxCutOff()),
+    table(table_)
+{
+    // Check that the particle types are valid.
+    for (unsigned int i=0;i<particles.size();i++)
+    {
+        if (particles[i].type >= table.getNumTypes())
+        {
+            std::cerr << "[ERROR] SquareWelliumMixture: Particle type exceeds size of interaction table!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+#ifndef ISOTROPIC
+double SquareWelliumMixture::computeEnergy(unsigned int particle, const double* position, const double* orientation)
+#else
+double SquareWelliumMixture::computeEnergy(unsigned int particle, const double* position)
+#endif
+{
+    // Energy counter.
+    double energy = 0;
+
+    unsigned int nCandidates = gatherCandidates(particle, candidates);
+
+    for (unsigned int i=0;i<nCandidates;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = gatherBlock(particle, position, i, nCandidates);
+
+        // Number of hard core overlaps.
+        unsigned int nOverlaps = 0;
+
+        // Evaluate the block.
+        for (unsigned int j=0;j<nBlock;j++)
+        {
+            nOverlaps += (blockNormSqd[j] < blockContact[j]);
+            energy -= (blockNormSqd[j] < blockCutOff[j])*blockEnergy[j];
+        }
+
+        // Early exit test for hard core overlaps.
+        if (nOverlaps > 0) return INF;
+    }
+
+    return energy;
+}
+
+#ifndef ISOTROPIC
+double SquareWelliumMixture::computePairEnergy(unsigned int particle1, const double* position1,
+    const double* orientation1, unsigned int particle2, const double* position2, const double* orientation2)
+#else
+double SquareWelliumMixture::computePairEnergy(unsigned int particle1,
+    const double* position1, unsigned int particle2, const double* position2)
+#endif
+{
+    // Separation vector.
+    std::vector<double> sep(box.dimension);
+
+    // Calculate separation.
+    for (unsigned int i=0;i<box.dimension;i++)
+        sep[i] = position1[i] - position2[i];
+
+    // Enforce minimum image.
+    box.minimumImage(sep);
+
+    double normSqd = 0;
+
+    // Calculate squared norm of vector.
+    for (unsigned int i=0;i<box.dimension;i++)
+        normSqd += sep[i]*sep[i];
+
+    // Pair parameters.
+    unsigned int type1 = particles[particle1].type;
+    unsigned int type2 = particles[particle2].type;
+
+    if (normSqd < table.getSquaredContacts(type1)[type2]) return INF;
+    if (normSqd < table.getSquaredCutOffs(type1)[type2]) return -table.getEnergies(type1)[type2];
+    return 0;
+}
+
+#ifndef ISOTROPIC
+unsigned int SquareWelliumMixture::computeInteractions(unsigned int particle,
+    const double* position, const double* orientation, unsigned int* interactions)
+#else
+unsigned int SquareWelliumMixture::computeInteractions(unsigned int particle,
+    const double* position, unsigned int* interactions)
+#endif
+{
+    // Interaction counter.
+    unsigned int nInteractions = 0;
+
+    unsigned int nCandidates = gatherCandidates(particle, candidates);
+
+    for (unsigned int i=0;i<nCandidates;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = gatherBlock(particle, position, i, nCandidates);
+
+        for (unsigned int j=0;j<nBlock;j++)
+        {
+            // Particles interact.
+            if (blockNormSqd[j] < blockCutOff[j])
+            {
+                if (nInteractions == maxInteractions)
+                {
+                    std::cerr << "[ERROR] SquareWelliumMixture: Maximum number of interactions exceeded!\n";
+                    exit(EXIT_FAILURE);
+                }
+
+                interactions[nInteractions] = candidates[i + j];
+                nInteractions++;
+            }
+        }
+    }
+
+    return nInteractions;
+}
+
+unsigned int SquareWelliumMixture::gatherBlock(unsigned int particle,
+    const double* position, unsigned int start, unsigned int nCandidates)
+{
+    unsigned int nBlock = std::min(BLOCK_SIZE, nCandidates - start);
+    const unsigned int* block = &candidates[start];
+
+    // Table rows for the species of the central particle.
+    unsigned int type = particles[particle].type;
+    const double* energies = table.getEnergies(type);
+    const double* squaredContacts = table.getSquaredContacts(type);
+    const double* squaredCutOffs = table.getSquaredCutOffs(type);
+
+    // Gather the pair parameters.
+    for (unsigned int i=0;i<nBlock;i++)
+    {
+        unsigned int neighbourType = particles[block[i]].type;
+        blockEnergy[i] = energies[neighbourType];
+        blockContact[i] = squaredContacts[neighbourType];
+        blockCutOff[i] = squaredCutOffs[neighbourType];
+        blockNormSqd[i] = 0;
+    }
+
+    // Accumulate the squared separations one axis at a time.
+    double sep[BLOCK_SIZE];
+    for (unsigned int i=0;i<box.dimension;i++)
+    {
+        for (unsigned int j=0;j<nBlock;j++)
+            sep[j] = position[i] - particles[block[j]].position[i];
+
+        box.minimumImage(i, sep, nBlock);
+
+        for (unsigned int j=0;j<nBlock;j++)
+            blockNormSqd[j] += sep[j]*sep[j];
+    }
+
+    return nBlock;
+}
@@ -0,0 +1,166 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SQUAREWELLIUMMIXTURE_H
+#define _SQUAREWELLIUMMIXTURE_H
+
+#include "Model.h"
+
+/*! \file SquareWelliumMixture.h
+    \brief A square-well potential for multicomponent mixtures.
+
+    The well depth, contact distance, and range for each pair are looked up
+    in an InteractionTable using the species, Particle::type, of the two
+    particles. Rather than evaluating the neighbours one at a time, the
+    candidates in the surrounding cells are processed in fixed-size blocks:
+    the separations and the pair parameters (gathered from the table row
+    for the central particle) are first copied into contiguous arrays, then
+    the energy of the block is evaluated in a single branch-free loop that
+    the compiler is free to vectorise. There is no branching on species.
+
+    The cell list must be initialised with the largest cut-off distance
+    in the table, InteractionTable::getMaxCutOff.
+*/
+
+// FORWARD DECLARATIONS
+
+class InteractionTable;
+
+//! Class defining the square-well potential for a multicomponent mixture.
+class SquareWelliumMixture : public Model
+{
+public:
+    //! Constructor.
+    /*! \param box_
+            A reference to the simulation box object.
+
+        \param particles_
+            A reference to the particle list.
+
+        \param cells_
+            A reference to the cell list object.
+
+        \param table_
+            A reference to the table of pair parameters.
+
+        \param maxInteractions_
+            The maximum number of interactions per particle.
+     */
+    SquareWelliumMixture(Box&, std::vector<Particle>&, CellList&, const InteractionTable&, unsigned int);
+
+    //! Calculate the total interaction energy felt by a particle.
+    /*! \param index
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the first particle.
+
+        \return
+            The total interaction energy.
+     */
+#ifndef ISOTROPIC
+    double computeEnergy(unsigned int, const double*, const double*);
+#else
+    double computeEnergy(unsigned int, const double*);
+#endif
+
+    //! Calculate the pair energy between two particles.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param position1
+            The position vector of the first particle.
+
+        \param orientation1
+            The orientation vector of the first particle.
+
+        \param particle2
+            The index of the second particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \param orientation2
+            The orientation vector of the second particle.
+
+        \return
+            The pair energy between particles 1 and 2.
+     */
+#ifndef ISOTROPIC
+    double computePairEnergy(unsigned int, const double*, const double*, unsigned int, const double*, const double*);
+#else
+    double computePairEnergy(unsigned int, const double*, unsigned int, const double*);
+#endif
+
+    //! Determine the interactions for a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the particle.
+
+        \param interactions
+            An array to store the indices of neighbours with which the particle interacts.
+
+        \return
+            The number of interactions.
+     */
+#ifndef ISOTROPIC
+    unsigned int computeInteractions(unsigned int, const double*, const double*, unsigned int*);
+#else
+    unsigned int computeInteractions(unsigned int, const double*, unsigned int*);
+#endif
+
+private:
+    //! The number of candidate neighbours processed in each block.
+    static const unsigned int BLOCK_SIZE = 64;
+
+    const InteractionTable& table;          //!< A reference to the table of pair parameters.
+
+    std::vector<unsigned int> candidates;   //!< The candidate neighbours of a particle.
+
+    double blockNormSqd[BLOCK_SIZE];        //!< The squared separation of each candidate in the block.
+    double blockEnergy[BLOCK_SIZE];         //!< The well depth for each candidate in the block.
+    double blockContact[BLOCK_SIZE];        //!< The squared contact distance for each candidate in the block.
+    double blockCutOff[BLOCK_SIZE];         //!< The squared cut-off distance for each candidate in the block.
+
+    //! Gather the separations and pair parameters for a block of candidates.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param start
+            The index of the first candidate in the block.
+
+        \param nCandidates
+            The total number of candidates.
+
+        \return
+            The number of candidates in the block.
+     */
+    unsigned int gatherBlock(unsigned int, const double*, unsigned int, unsigned int);
+};
+
+#endif  /* _SQUAREWELLIUMMIXTURE_H */
@@ -0,0 +1,444 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "Box.h"
+#include "CellList.h"
+#include "Particle.h"
+#include "SquareWelliumRod.h"
+
+const unsigned int SquareWelliumRod::BLOCK_SIZE;
+
+//! Compute an orthonormal set of axes with the first along a rod.
+/*! \param orientation
+        The orientation vector of the rod.
+
+    \param axes
+        An array in which to store the three axes.
+ */
+static void computeAxes(const double* orientation, double axes[3][3])
+{
+    for (unsigned int i=0;i<3;i++)
+        axes[0][i] = orientation[i];
+
+    // Cross the orientation with the axis it is least aligned with.
+    unsigned int axis = 0;
+    for (unsigned int i=1;i<3;i++)
+        if (std::abs(orientation[i]) < std::abs(orientation[axis])) axis = i;
+
+    double a[3] = {0, 0, 0};
+    a[axis] = 1;
+
+    axes[1][0] = orientation[1]*a[2] - orientation[2]*a[1];
+    axes[1][1] = orientation[2]*a[0] - orientation[0]*a[2];
+    axes[1][2] = orientation[0]*a[1] - orientation[1]*a[0];
+
+    double norm = std::sqrt(axes[1][0]*axes[1][0] + axes[1][1]*axes[1][1] + axes[1][2]*axes[1][2]);
+    for (unsigned int i=0;i<3;i++) axes[1][i] /= norm;
+
+    axes[2][0] = orientation[1]*axes[1][2] - orientation[2]*axes[1][1];
+    axes[2][1] = orientation[2]*axes[1][0] - orientation[0]*axes[1][2];
+    axes[2][2] = orientation[0]*axes[1][1] - orientation[1]*axes[1][0];
+}
+
+//! Separating axis test for pairs of oriented boxes of equal size (Ericson, Real-Time Collision Detection, 2005).
+/*! Pairs are stored in structure-of-arrays form, and the tests are
+    combined without branching by taking the largest separation along any
+    candidate axis, so that the loop over the block is vectorised.
+
+    \param nPairs
+        The number of pairs.
+
+    \param t
+        The separation between the box centres in the frame of the first box of each pair.
+
+    \param R
+        The rotation matrix between the frames of each pair, R[i][j] = a_i . b_j.
+
+    \param extent
+        The half-widths of the boxes.
+
+    \param separations
+        An array in which to store the largest separation of the boxes of each pair,
+        which is positive if they don't intersect.
+ */
+static void computeSeparations(unsigned int nPairs, const double t[3][SquareWelliumRod::BLOCK_SIZE],
+    const double R[3][3][SquareWelliumRod::BLOCK_SIZE], const double extent[3], double separations[])
+{
+    // Copy the extents, since they could otherwise alias the output.
+    const double e[3] = {extent[0], extent[1], extent[2]};
+
+    for (unsigned int k=0;k<nPairs;k++)
+    {
+        // Absolute rotation matrix (padded to guard against parallel axes).
+        double absR[3][3];
+        for (unsigned int i=0;i<3;i++)
+            for (unsigned int j=0;j<3;j++)
+                absR[i][j] = std::abs(R[i][j][k]) + 1e-12;
+
+        double separation = -INFINITY;
+
+        // Axes of the first box.
+        for (unsigned int i=0;i<3;i++)
+        {
+            double rb = e[0]*absR[i][0] + e[1]*absR[i][1] + e[2]*absR[i][2];
+            separation = std::max(separation, std::abs(t[i][k]) - (e[i] + rb));
+        }
+
+        // Axes of the second box.
+        for (unsigned int j=0;j<3;j++)
+        {
+            double ra = e[0]*absR[0][j] + e[1]*absR[1][j] + e[2]*absR[2][j];
+            separation = std::max(separation,
+                std::abs(t[0][k]*R[0][j][k] + t[1][k]*R[1][j][k] + t[2][k]*R[2][j][k]) - (ra + e[j]));
+        }
+
+        // Cross products of the axes.
+        for (unsigned int i=0;i<3;i++)
+        {
+            unsigned int i1 = (i + 1) % 3;
+            unsigned int i2 = (i + 2) % 3;
+
+            for (unsigned int j=0;j<3;j++)
+            {
+                unsigned int j1 = (j + 1) % 3;
+                unsigned int j2 = (j + 2) % 3;
+
+                double ra = e[i1]*absR[i2][j] + e[i2]*absR[i1][j];
+                double rb = e[j1]*absR[i][j2] + e[j2]*absR[i][j1];
+
+                separation = std::max(separation, std::abs(t[i2][k]*R[i1][j][k] - t[i1][k]*R[i2][j][k]) - (ra + rb));
+            }
+        }
+
+        separations[k] = separation;
+    }
+}
+
+SquareWelliumRod::SquareWelliumRod(
+    Box& box_,
+    std::vector<Particle>& particles_,
+    CellList& cells_,
+    unsigned int maxInteractions_,
+    double interactionEnergy_,
+    double interactionRange_,
+    double length_) :
+    Model(box_, particles_, cells_, maxInteractions_, interactionEnergy_, interactionRange_),
+    length(length_)
+{
+#ifdef ISOTROPIC
+    std::cerr << "[ERROR] SquareWelliumRod: Cannot be used with isotropic VMMC library!\n";
+    exit(EXIT_FAILURE);
+#endif
+
+    // Check dimensionality.
+    if (box.dimension != 3)
+    {
+        std::cerr << "[ERROR] SquareWelliumRod: Model only valid in three dimensions!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    if ((length < 0) || (interactionRange < 1))
+    {
+        std::cerr << "[ERROR] SquareWelliumRod: Invalid rod length or interaction range!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Rods can only interact if their centres lie within this distance.
+    squaredBoundingDistance = (length + interactionRange)*(length + interactionRange);
+
+    // Half-widths of the box enclosing the interaction envelope of each rod.
+    double radius = 0.5*interactionRange;
+    extent[0] = 0.5*length + radius;
+    extent[1] = radius;
+    extent[2] = radius;
+
+    // No axes have been cached yet (NaN never compares equal).
+    axes.resize(9*particles.size());
+    axesOrientations.assign(3*particles.size(), NAN);
+}
+
+double SquareWelliumRod::computeEnergy(unsigned int particle, const double* position, const double* orientation)
+{
+    // Energy counter.
+    double energy = 0;
+
+    unsigned int nSurvivors = filterNeighbours(particle, position);
+    nSurvivors = filterBoxes(orientation, nSurvivors);
+
+    for (unsigned int i=0;i<nSurvivors;i++)
+    {
+        energy += computeRodEnergy(&separations[3*i], orientation,
+            &particles[survivors[i]].orientation[0]);
+
+        // Early exit test for hard core overlaps.
+        if (energy > 1e6) return INF;
+    }
+
+    return energy;
+}
+
+double SquareWelliumRod::computePairEnergy(unsigned int particle1, const double* position1,
+    const double* orientation1, unsigned int particle2, const double* position2, const double* orientation2)
+{
+    // Separation vector.
+    std::vector<double> sep(3);
+
+    // Calculate separation.
+    for (unsigned int i=0;i<3;i++)
+        sep[i] = position2[i] - position1[i];
+
+    // Enforce minimum image.
+    box.minimumImage(sep);
+
+    // Bounding sphere test.
+    if ((sep[0]*sep[0] + sep[1]*sep[1] + sep[2]*sep[2]) >= squaredBoundingDistance) return 0;
+
+    // Bounding box test.
+    double a[3][3], b[3][3];
+    computeAxes(orientation1, a);
+    computeAxes(orientation2, b);
+
+    double t[3][BLOCK_SIZE], R[3][3][BLOCK_SIZE];
+    for (unsigned int i=0;i<3;i++)
+    {
+        t[i][0] = sep[0]*a[i][0] + sep[1]*a[i][1] + sep[2]*a[i][2];
+
+        for (unsigned int j=0;j<3;j++)
+            R[i][j][0] = a[i][0]*b[j][0] + a[i][1]*b[j][1] + a[i][2]*b[j][2];
+    }
+
+    double separation;
+    computeSeparations(1, t, R, extent, &separation);
+    if (separation > 0) return 0;
+
+    return computeRodEnergy(&sep[0], orientation1, orientation2);
+}
+
+unsigned int SquareWelliumRod::computeInteractions(unsigned int particle,
+    const double* position, const double* orientation, unsigned int* interactions)
+{
+    // Interaction counter.
+    unsigned int nInteractions = 0;
+
+    unsigned int nSurvivors = filterNeighbours(particle, position);
+    nSurvivors = filterBoxes(orientation, nSurvivors);
+
+    for (unsigned int i=0;i<nSurvivors;i++)
+    {
+        // Particles interact.
+        if (computeRodEnergy(&separations[3*i], orientation, &particles[survivors[i]].orientation[0]) != 0)
+        {
+            if (nInteractions == maxInteractions)
+            {
+                std::cerr << "[ERROR] SquareWelliumRod: Maximum number of interactions exceeded!\n";
+                exit(EXIT_FAILURE);
+            }
+
+            interactions[nInteractions] = survivors[i];
+            nInteractions++;
+        }
+    }
+
+    return nInteractions;
+}
+
+double SquareWelliumRod::computeSegmentDistance(const double* sep,
+    const double* orientation1, const double* orientation2) const
+{
+    // Closest approach of two finite segments (Vega and Lago, Comput. Chem. 18, 55, 1994).
+    double halfLength = 0.5*length;
+
+    double rr = sep[0]*sep[0] + sep[1]*sep[1] + sep[2]*sep[2];
+    double rw1 = sep[0]*orientation1[0] + sep[1]*orientation1[1] + sep[2]*orientation1[2];
+    double rw2 = sep[0]*orientation2[0] + sep[1]*orientation2[1] + sep[2]*orientation2[2];
+    double w1w2 = orientation1[0]*orientation2[0] + orientation1[1]*orientation2[1] + orientation1[2]*orientation2[2];
+    double cc = 1.0 - w1w2*w1w2;
+
+    // Positions of the closest points along each segment.
+    double lambda, mu;
+
+    if (cc < 1e-6)
+    {
+        // Rods are (almost) parallel.
+        lambda = 0.5*rw1;
+        mu = -0.5*rw2;
+    }
+    else
+    {
+        lambda = (rw1 - w1w2*rw2)/cc;
+        mu = (w1w2*rw1 - rw2)/cc;
+    }
+
+    // Clamp to the ends of the segments.
+    if ((std::abs(lambda) > halfLength) || (std::abs(mu) > halfLength))
+    {
+        if ((std::abs(lambda) - halfLength) > (std::abs(mu) - halfLength))
+        {
+            lambda = std::copysign(halfLength, lambda);
+            mu = lambda*w1w2 - rw2;
+            if (std::abs(mu) > halfLength) mu = std::copysign(halfLength, mu);
+        }
+        else
+        {
+            mu = std::copysign(halfLength, mu);
+            lambda = mu*w1w2 + rw1;
+            if (std::abs(lambda) > halfLength) lambda = std::copysign(halfLength, lambda);
+        }
+    }
+
+    return rr + lambda*lambda + mu*mu - 2.0*lambda*mu*w1w2 + 2.0*mu*rw2 - 2.0*lambda*rw1;
+}
+
+unsigned int SquareWelliumRod::filterNeighbours(unsigned int particle, const double* position)
+{
+    unsigned int nCandidates = gatherCandidates(particle, candidates);
+
+    // Make sure there is enough space to store the survivors.
+    if (survivors.size() < nCandidates)
+    {
+        survivors.resize(nCandidates);
+        separations.resize(3*nCandidates);
+    }
+
+    unsigned int nSurvivors = 0;
+
+    double sep[3][BLOCK_SIZE];
+    double normSqd[BLOCK_SIZE];
+
+    for (unsigned int i=0;i<nCandidates;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = std::min(BLOCK_SIZE, nCandidates - i);
+        const unsigned int* block = &candidates[i];
+
+        for (unsigned int j=0;j<nBlock;j++)
+            normSqd[j] = 0;
+
+        // Accumulate the squared separations one axis at a time.
+        for (unsigned int j=0;j<3;j++)
+        {
+            for (unsigned int k=0;k<nBlock;k++)
+                sep[j][k] = particles[block[k]].position[j] - position[j];
+
+            box.minimumImage(j, sep[j], nBlock);
+
+            for (unsigned int k=0;k<nBlock;k++)
+                normSqd[k] += sep[j][k]*sep[j][k];
+        }
+
+        // Compact the neighbours that pass the bounding sphere test.
+        for (unsigned int j=0;j<nBlock;j++)
+        {
+            survivors[nSurvivors] = block[j];
+            separations[3*nSurvivors]     = sep[0][j];
+            separations[3*nSurvivors + 1] = sep[1][j];
+            separations[3*nSurvivors + 2] = sep[2][j];
+            nSurvivors += (normSqd[j] < squaredBoundingDistance);
+        }
+    }
+
+    return nSurvivors;
+}
+
+unsigned int SquareWelliumRod::filterBoxes(const double* orientation, unsigned int nSurvivors)
+{
+    // Axes of the particle, which are shared by every pair.
+    double a[3][3];
+    computeAxes(orientation, a);
+
+    unsigned int nOverlaps = 0;
+
+    double t[3][BLOCK_SIZE];
+    double R[3][3][BLOCK_SIZE];
+    double boxSeparations[BLOCK_SIZE];
+
+    for (unsigned int i=0;i<nSurvivors;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = std::min(BLOCK_SIZE, nSurvivors - i);
+
+        // Cached axes of the neighbours.
+        const double* b[BLOCK_SIZE];
+        for (unsigned int k=0;k<nBlock;k++)
+            b[k] = getAxes(survivors[i + k]);
+
+        // Rotation between the frames and separation in the frame of the particle.
+        for (unsigned int j=0;j<3;j++)
+        {
+            for (unsigned int k=0;k<nBlock;k++)
+            {
+                const double* sep = &separations[3*(i + k)];
+                t[j][k] = sep[0]*a[j][0] + sep[1]*a[j][1] + sep[2]*a[j][2];
+
+                for (unsigned int l=0;l<3;l++)
+                    R[j][l][k] = a[j][0]*b[k][3*l] + a[j][1]*b[k][3*l + 1] + a[j][2]*b[k][3*l + 2];
+            }
+        }
+
+        // Separating axis test for each pair.
+        computeSeparations(nBlock, t, R, extent, boxSeparations);
+
+        // Compact the neighbours whose boxes intersect (in place, since nOverlaps <= i + k).
+        for (unsigned int k=0;k<nBlock;k++)
+        {
+            unsigned int survivor = i + k;
+
+            survivors[nOverlaps] = survivors[survivor];
+            separations[3*nOverlaps]     = separations[3*survivor];
+            separations[3*nOverlaps + 1] = separations[3*survivor + 1];
+            separations[3*nOverlaps + 2] = separations[3*survivor + 2];
+            nOverlaps += (boxSeparations[k] <= 0);
+        }
+    }
+
+    return nOverlaps;
+}
+
+const double* SquareWelliumRod::getAxes(unsigned int particle)
+{
+    const double* orientation = &particles[particle].orientation[0];
+    double* cached = &axesOrientations[3*particle];
+
+    // Recompute the axes if the particle has rotated.
+    if ((orientation[0] != cached[0]) || (orientation[1] != cached[1]) || (orientation[2] != cached[2]))
+    {
+        double b[3][3];
+        computeAxes(orientation, b);
+
+        for (unsigned int i=0;i<3;i++)
+        {
+            cached[i] = orientation[i];
+            for (unsigned int j=0;j<3;j++)
+                axes[9*particle + 3*i + j] = b[i][j];
+        }
+    }
+
+    return &axes[9*particle];
+}
+
+double SquareWelliumRod::computeRodEnergy(const double* sep,
+    const double* orientation1, const double* orientation2) const
+{
+    double distSqd = computeSegmentDistance(sep, orientation1, orientation2);
+
+    if (distSqd < 1) return INF;
+    if (distSqd < squaredCutOffDistance) return -interactionEnergy;
+    return 0;
+}
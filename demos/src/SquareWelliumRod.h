@@ -0,0 +1,211 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SQUAREWELLIUMROD_H
+#define _SQUAREWELLIUMROD_H
+
+#include "Model.h"
+
+/*! \file SquareWelliumRod.h
+    \brief A square-well potential between spherocylinders.
+
+    Each particle is a spherocylinder of unit diameter whose axis, of the
+    given length, lies along the particle's orientation vector. Two rods
+    overlap if the shortest distance between their axis segments is less
+    than one, and attract with energy -interactionEnergy if it is less
+    than interactionRange.
+
+    The exact segment-segment distance is only computed for pairs that
+    survive two cheaper tests. First, the centres must lie within
+    length + interactionRange of one another. This test is applied to
+    blocks of candidate neighbours in a branch-free loop that the compiler
+    can vectorise, with the survivors compacted into a list. Second, the
+    oriented bounding boxes of the interaction envelopes of the two rods
+    (a capsule of radius interactionRange/2 around each axis) must
+    intersect, which is checked using the separating axis theorem. This
+    test is also applied to blocks of survivors, using the axes of each rod,
+    which are cached and only recomputed once the rod has rotated.
+*/
+
+//! Class defining the square-well potential between spherocylinders.
+class SquareWelliumRod : public Model
+{
+public:
+    //! Constructor.
+    /*! \param box_
+            A reference to the simulation box object.
+
+        \param particles_
+            A reference to the particle list.
+
+        \param cells_
+            A reference to the cell list object.
+
+        \param maxInteractions_
+            The maximum number of interactions per particle.
+
+        \param interactionEnergy_
+            The square well interaction energy (in units of kBT).
+
+        \param interactionRange_
+            The square well interaction range (in units of the rod diameter).
+
+        \param length_
+            The length of the rod axis (in units of the rod diameter).
+     */
+    SquareWelliumRod(Box&, std::vector<Particle>&, CellList&, unsigned int, double, double, double);
+
+    //! Calculate the total interaction energy felt by a particle.
+    /*! \param index
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the first particle.
+
+        \return
+            The total interaction energy.
+     */
+    double computeEnergy(unsigned int, const double*, const double*);
+
+    //! Calculate the pair energy between two particles.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param position1
+            The position vector of the first particle.
+
+        \param orientation1
+            The orientation vector of the first particle.
+
+        \param particle2
+            The index of the second particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \param orientation2
+            The orientation vector of the second particle.
+
+        \return
+            The pair energy between particles 1 and 2.
+     */
+    double computePairEnergy(unsigned int, const double*, const double*, unsigned int, const double*, const double*);
+
+    //! Determine the interactions for a given particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the particle.
+
+        \param interactions
+            An array to store the indices of neighbours with which the particle interacts.
+
+        \return
+            The number of interactions.
+     */
+    unsigned int computeInteractions(unsigned int, const double*, const double*, unsigned int*);
+
+    //! Compute the squared distance between two rod axes.
+    /*! \param sep
+            The separation vector between the rod centres.
+
+        \param orientation1
+            The orientation vector of the first rod.
+
+        \param orientation2
+            The orientation vector of the second rod.
+
+        \return
+            The squared shortest distance between the axis segments.
+     */
+    double computeSegmentDistance(const double*, const double*, const double*) const;
+
+    //! The number of candidate neighbours processed in each block.
+    static const unsigned int BLOCK_SIZE = 64;
+
+private:
+    double length;                          //!< The length of the rod axis.
+    double squaredBoundingDistance;         //!< The squared bounding sphere cut-off.
+    double extent[3];                       //!< The half-widths of the bounding box of each rod.
+
+    std::vector<double> axes;               //!< The cached axes of each rod.
+    std::vector<double> axesOrientations;   //!< The orientation of each rod when its axes were cached.
+
+    std::vector<unsigned int> candidates;   //!< The candidate neighbours of a particle.
+    std::vector<unsigned int> survivors;    //!< The neighbours passing the bounding sphere test.
+    std::vector<double> separations;        //!< The separation vectors of the survivors.
+
+    //! Find the neighbours within the bounding sphere of a particle.
+    /*! \param particle
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \return
+            The number of neighbours passing the test.
+     */
+    unsigned int filterNeighbours(unsigned int, const double*);
+
+    //! Find the neighbours whose bounding boxes intersect that of a particle.
+    /*! Neighbours are taken from, and compacted into, the list of survivors
+        of the bounding sphere test.
+
+        \param orientation
+            The orientation vector of the particle.
+
+        \param nSurvivors
+            The number of neighbours passing the bounding sphere test.
+
+        \return
+            The number of neighbours passing the test.
+     */
+    unsigned int filterBoxes(const double*, unsigned int);
+
+    //! Get the axes of a rod, recomputing them if it has rotated.
+    /*! \param particle
+            The particle index.
+
+        \return
+            A pointer to the three axes of the rod.
+     */
+    const double* getAxes(unsigned int);
+
+    //! Compute the energy of a pair whose bounding boxes intersect.
+    /*! \param sep
+            The separation vector between the rod centres.
+
+        \param orientation1
+            The orientation vector of the first rod.
+
+        \param orientation2
+            The orientation vector of the second rod.
+
+        \return
+            The pair energy.
+     */
+    double computeRodEnergy(const double*, const double*, const double*) const;
+};
+
+#endif  /* _SQUAREWELLIUMROD_H */
@@ -0,0 +1,265 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "Box.h"
+#include "CellList.h"
+#include "Particle.h"
+#include "TabulatedModel.h"
+
+const unsigned int TabulatedModel::BLOCK_SIZE;
+
+//! Compute the second derivatives of a natural cubic spline.
+/*! \param x
+        The sample points (in increasing order).
+
+    \param y
+        The sample values.
+
+    \param y2
+        A vector in which to store the second derivatives at each sample.
+ */
+static void computeSpline(const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& y2)
+{
+    unsigned int n = x.size();
+    std::vector<double> u(n, 0);
+
+    y2.assign(n, 0);
+
+    // Tridiagonal decomposition (natural boundary conditions).
+    for (unsigned int i=1;i<n-1;i++)
+    {
+        double sig = (x[i] - x[i-1])/(x[i+1] - x[i-1]);
+        double p = sig*y2[i-1] + 2.0;
+        y2[i] = (sig - 1.0)/p;
+        u[i] = (y[i+1] - y[i])/(x[i+1] - x[i]) - (y[i] - y[i-1])/(x[i] - x[i-1]);
+        u[i] = (6.0*u[i]/(x[i+1] - x[i-1]) - sig*u[i-1])/p;
+    }
+
+    // Back substitution.
+    for (int i=n-2;i>=0;i--)
+        y2[i] = y2[i]*y2[i+1] + u[i];
+}
+
+TabulatedModel::TabulatedModel(
+    Box& box_,
+    std::vector<Particle>& particles_,
+    CellList& cells_,
+    unsigned int maxInteractions_,
+    const std::vector<double>& squaredSeparations,
+    const std::vector<double>& energies,
+    Interpolation interpolation,
+    unsigned int nBins_) :
+    Model(box_, particles_, cells_, maxInteractions_, 1.0,
+        std::sqrt(squaredSeparations.empty() ? 0 : squaredSeparations.back())),
+    nBins(nBins_)
+{
+    unsigned int nSamples = squaredSeparations.size();
+
+    // Check the table.
+    if ((nSamples < 2) || (energies.size() != nSamples) || (nBins == 0))
+    {
+        std::cerr << "[ERROR] TabulatedModel: Invalid potential table!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int i=1;i<nSamples;i++)
+    {
+        if (squaredSeparations[i] <= squaredSeparations[i-1])
+        {
+            std::cerr << "[ERROR] TabulatedModel: Separations must be in increasing order!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    squaredMinimum = squaredSeparations[0];
+    double binWidth = (squaredSeparations.back() - squaredMinimum)/nBins;
+    invBinWidth = 1.0/binWidth;
+
+    // Second derivatives of the input spline.
+    std::vector<double> y2(nSamples, 0);
+    if (interpolation == SPLINE) computeSpline(squaredSeparations, energies, y2);
+
+    // Resample the potential onto a uniform grid.
+    std::vector<double> grid(nBins + 1);
+    std::vector<double> values(nBins + 1);
+
+    for (unsigned int i=0;i<=nBins;i++)
+    {
+        grid[i] = squaredMinimum + i*binWidth;
+        if (i == nBins) grid[i] = squaredSeparations.back();
+
+        // Locate the input interval containing the grid point.
+        unsigned int k = std::upper_bound(squaredSeparations.begin(),
+            squaredSeparations.end(), grid[i]) - squaredSeparations.begin();
+        k = std::min(std::max(k, 1u), nSamples - 1);
+
+        double h = squaredSeparations[k] - squaredSeparations[k-1];
+        double a = (squaredSeparations[k] - grid[i])/h;
+        double b = 1.0 - a;
+
+        values[i] = a*energies[k-1] + b*energies[k]
+                  + ((a*a*a - a)*y2[k-1] + (b*b*b - b)*y2[k])*(h*h)/6.0;
+    }
+
+    // Second derivatives on the uniform grid.
+    std::vector<double> gridY2(nBins + 1, 0);
+    if (interpolation == SPLINE) computeSpline(grid, values, gridY2);
+
+    allocate();
+
+    // Work out the polynomial coefficients for each bin, in terms of the
+    // fractional position within the bin.
+    for (unsigned int i=0;i<nBins;i++)
+    {
+        double h2 = binWidth*binWidth;
+
+        coefficients[4*i]     = values[i];
+        coefficients[4*i + 1] = values[i+1] - values[i] - h2*(2.0*gridY2[i] + gridY2[i+1])/6.0;
+        coefficients[4*i + 2] = 0.5*h2*gridY2[i];
+        coefficients[4*i + 3] = h2*(gridY2[i+1] - gridY2[i])/6.0;
+    }
+}
+
+TabulatedModel::TabulatedModel(const TabulatedModel& model) :
+    Model(model),
+    nBins(model.nBins),
+    squaredMinimum(model.squaredMinimum),
+    invBinWidth(model.invBinWidth)
+{
+    // Copy the coefficients (the alignment offset may differ).
+    allocate();
+    std::copy(model.coefficients, model.coefficients + 4*nBins, coefficients);
+}
+
+#ifndef ISOTROPIC
+double TabulatedModel::computeEnergy(unsigned int particle, const double* position, const double* orientation)
+#else
+double TabulatedModel::computeEnergy(unsigned int particle, const double* position)
+#endif
+{
+    // Energy counter.
+    double energy = 0;
+
+    unsigned int nCandidates = gatherCandidates(particle, candidates);
+    const unsigned int* block = candidates.data();
+
+    double normSqd[BLOCK_SIZE];
+    double sep[BLOCK_SIZE];
+
+    for (unsigned int i=0;i<nCandidates;i+=BLOCK_SIZE)
+    {
+        unsigned int nBlock = std::min(BLOCK_SIZE, nCandidates - i);
+
+        for (unsigned int j=0;j<nBlock;j++)
+            normSqd[j] = 0;
+
+        // Accumulate the squared separations one axis at a time.
+        for (unsigned int j=0;j<box.dimension;j++)
+        {
+            for (unsigned int k=0;k<nBlock;k++)
+                sep[k] = position[j] - particles[block[i + k]].position[j];
+
+            box.minimumImage(j, sep, nBlock);
+
+            for (unsigned int k=0;k<nBlock;k++)
+                normSqd[k] += sep[k]*sep[k];
+        }
+
+        // Number of hard core overlaps.
+        unsigned int nOverlaps = 0;
+
+        // Evaluate the block.
+        for (unsigned int j=0;j<nBlock;j++)
+        {
+            // Clamp to the table so that the lookup is always valid.
+            double x = std::min(std::max((normSqd[j] - squaredMinimum)*invBinWidth, 0.0), double(nBins));
+            unsigned int bin = std::min((unsigned int) x, nBins - 1);
+            double f = x - bin;
+
+            const double* c = coefficients + 4*bin;
+            double value = ((c[3]*f + c[2])*f + c[1])*f + c[0];
+
+            nOverlaps += (normSqd[j] < squaredMinimum);
+            energy += (normSqd[j] >= squaredMinimum)*(normSqd[j] < squaredCutOffDistance)*value;
+        }
+
+        // Early exit test for hard core overlaps.
+        if (nOverlaps > 0) return INF;
+    }
+
+    // Early exit test for large finite energy repulsions.
+    if (energy > 1e6) return INF;
+
+    return energy;
+}
+
+#ifndef ISOTROPIC
+double TabulatedModel::computePairEnergy(unsigned int particle1, const double* position1,
+    const double* orientation1, unsigned int particle2, const double* position2, const double* orientation2)
+#else
+double TabulatedModel::computePairEnergy(unsigned int particle1,
+    const double* position1, unsigned int particle2, const double* position2)
+#endif
+{
+    // Separation vector.
+    std::vector<double> sep(box.dimension);
+
+    // Calculate separation.
+    for (unsigned int i=0;i<box.dimension;i++)
+        sep[i] = position1[i] - position2[i];
+
+    // Enforce minimum image.
+    box.minimumImage(sep);
+
+    double normSqd = 0;
+
+    // Calculate squared norm of vector.
+    for (unsigned int i=0;i<box.dimension;i++)
+        normSqd += sep[i]*sep[i];
+
+    return computeTabulatedEnergy(normSqd);
+}
+
+double TabulatedModel::computeTabulatedEnergy(double normSqd) const
+{
+    if (normSqd < squaredMinimum) return INF;
+    if (normSqd >= squaredCutOffDistance) return 0;
+
+    double x = std::min((normSqd - squaredMinimum)*invBinWidth, double(nBins));
+    unsigned int bin = std::min((unsigned int) x, nBins - 1);
+    double f = x - bin;
+
+    const double* c = coefficients + 4*bin;
+    return ((c[3]*f + c[2])*f + c[1])*f + c[0];
+}
+
+void TabulatedModel::allocate()
+{
+    // Allocate an extra cache line so that the table can be aligned.
+    storage.assign(4*nBins + 8, 0);
+
+    // Offset (in doubles) to the first cache line boundary.
+    unsigned int offset = ((64 - (reinterpret_cast<std::uintptr_t>(&storage[0]) % 64)) % 64)/sizeof(double);
+
+    coefficients = &storage[offset];
+}
@@ -0,0 +1,159 @@
+/*
+  Copyright (c) 2015-2016 Lester Hedges <lester.hedges+vmmc@gmail.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TABULATEDMODEL_H
+#define _TABULATEDMODEL_H
+
+#include "Model.h"
+
+/*! \file TabulatedModel.h
+    \brief An isotropic pair potential interpolated from a table.
+
+    The potential is supplied as a set of samples of the pair energy as a
+    function of the squared separation, r^2, so that no square root is needed
+    when evaluating it. The samples are resampled onto a uniform grid in r^2
+    and the coefficients of a cubic (natural spline) or linear polynomial
+    for each bin are precomputed. The four coefficients for each bin are
+    stored together in a cache-aligned array, so a lookup touches a single
+    cache line.
+
+    Separations below the first sample are treated as hard core overlaps,
+    and the potential is zero beyond the last sample, which sets the cut-off.
+    Like SquareWelliumMixture, the energy felt by a particle is evaluated by
+    gathering its neighbours in blocks and processing each block in a
+    branch-free loop that the compiler can vectorise.
+*/
+
+//! Class defining a tabulated isotropic pair potential.
+class TabulatedModel : public Model
+{
+public:
+    //! The interpolation scheme.
+    enum Interpolation
+    {
+        LINEAR,     //!< Piecewise linear interpolation.
+        SPLINE      //!< Natural cubic spline interpolation.
+    };
+
+    //! Constructor.
+    /*! \param box_
+            A reference to the simulation box object.
+
+        \param particles_
+            A reference to the particle list.
+
+        \param cells_
+            A reference to the cell list object.
+
+        \param maxInteractions_
+            The maximum number of interactions per particle.
+
+        \param squaredSeparations
+            The squared separations at which the potential is sampled (in increasing order).
+
+        \param energies
+            The pair energy at each sample (in units of kBT).
+
+        \param interpolation
+            The interpolation scheme.
+
+        \param nBins_
+            The number of bins in the precomputed table.
+     */
+    TabulatedModel(Box&, std::vector<Particle>&, CellList&, unsigned int, const std::vector<double>&,
+        const std::vector<double>&, Interpolation interpolation = SPLINE, unsigned int nBins_ = 1000);
+
+    //! Copy constructor.
+    /*! \param model
+            A reference to an existing TabulatedModel object.
+     */
+    TabulatedModel(const TabulatedModel&);
+
+    //! Calculate the total interaction energy felt by a particle.
+    /*! \param index
+            The particle index.
+
+        \param position
+            The position vector of the particle.
+
+        \param orientation
+            The orientation vector of the first particle.
+
+        \return
+            The total interaction energy.
+     */
+#ifndef ISOTROPIC
+    double computeEnergy(unsigned int, const double*, const double*);
+#else
+    double computeEnergy(unsigned int, const double*);
+#endif
+
+    //! Calculate the pair energy between two particles.
+    /*! \param particle1
+            The index of the first particle.
+
+        \param position1
+            The position vector of the first particle.
+
+        \param orientation1
+            The orientation vector of the first particle.
+
+        \param particle2
+            The index of the second particle.
+
+        \param position2
+            The position vector of the second particle.
+
+        \param orientation2
+            The orientation vector of the second particle.
+
+        \return
+            The pair energy between particles 1 and 2.
+     */
+#ifndef ISOTROPIC
+    double computePairEnergy(unsigned int, const double*, const double*, unsigned int, const double*, const double*);
+#else
+    double computePairEnergy(unsigned int, const double*, unsigned int, const double*);
+#endif
+
+    //! Evaluate the tabulated potential.
+    /*! \param normSqd
+            The squared separation.
+
+        \return
+            The pair energy.
+     */
+    double computeTabulatedEnergy(double) const;
+
+private:
+    //! The number of candidate neighbours processed in each block.
+    static const unsigned int BLOCK_SIZE = 64;
+
+    unsigned int nBins;                     //!< The number of bins in the table.
+    double squaredMinimum;                  //!< The squared hard core distance.
+    double invBinWidth;                     //!< The inverse bin width (in r^2).
+
+    std::vector<double> storage;            //!< The raw storage for the coefficients.
+    double* coefficients;                   //!< The (aligned) polynomial coefficients for each bin.
+
+    std::vector<unsigned int> candidates;   //!< The candidate neighbours of a particle.
+
+    //! Allocate the aligned coefficient table.
+    void allocate();
+};
+
+#endif  /* _TABULATEDMODEL_H */
@@ -54,6 +54,16 @@ public:
          */
     }
 
+    //! Constructor.
+    /*! \param seed_
+            The generator seed. Use this when the state will be overwritten,
+            e.g. by assignment, to avoid reading the hardware random device.
+     */
+    explicit MersenneTwister(unsigned int seed_)
+    {
+        setSeed(seed_);
+    }
+
     //! Overloaded () operator.
     /*! \return A uniform random double in range [0-1]. */
     double operator()()
@@ -15,13 +15,21 @@
   along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 
 #include "VMMC.h"
 
+#ifndef M_PI
+    #define M_PI 3.1415926535897932384626433832795
+#endif
+
 namespace vmmc
 {
+    const int VMMC::MAX_LEVEL;
+
     Particle::Particle() {}
 
     Particle::Particle(unsigned int dimension)
@@ -30,6 +38,7 @@ namespace vmmc
         preMovePosition.resize(dimension);
         postMovePosition.resize(dimension);
         clusterPosition.resize(dimension);
+        imageShift.resize(dimension);
 #ifndef ISOTROPIC
         preMoveOrientation.resize(dimension);
         postMoveOrientation.resize(dimension);
@@ -66,7 +75,20 @@ namespace vmmc
         referenceRadius(referenceRadius_),
         maxInteractions(maxInteractions_),
         isRepusive(isRepusive_),
-        callbacks(callbacks_)
+        callbacks(callbacks_),
+        probAVB(0),
+        nAttemptsAVB(0),
+        nAcceptsAVB(0),
+        probVolume(0),
+        nAttemptsVolume(0),
+        nAcceptsVolume(0),
+        probSwap(0),
+        nAttemptsSwap(0),
+        nAcceptsSwap(0),
+        isDiscrete(false),
+        energyQuantum(0),
+        inverseQuantum(0),
+        maxLevel(0)
     {
         // Check number of particles.
         if ((nParticles == 0) ||
@@ -125,11 +147,14 @@ namespace vmmc
 
         // Allocate memory.
         moveParams.trialVector.resize(dimension);
+        moveParams.isRotation = false;
         particles.resize(nParticles);
         moveList.resize(nParticles);
         clusterTranslations.resize(nParticles);
         clusterRotations.resize(nParticles);
         frustratedLinks.resize(nParticles);
+        affectedList.resize(nParticles);
+        images.resize(dimension*nParticles);
 #ifndef ISOTROPIC
         isIsotropic.resize(nParticles);
 #endif
@@ -141,6 +166,7 @@ namespace vmmc
             particles[i].preMovePosition.resize(dimension);
             particles[i].postMovePosition.resize(dimension);
             particles[i].clusterPosition.resize(dimension);
+            particles[i].imageShift.resize(dimension);
 #ifndef ISOTROPIC
             particles[i].preMoveOrientation.resize(dimension);
             particles[i].postMoveOrientation.resize(dimension);
@@ -152,6 +178,9 @@ namespace vmmc
             // Initialise frustrated boolean flag.
             particles[i].isFrustrated = false;
 
+            // Initialise affected boolean flag.
+            particles[i].isAffected = false;
+
             // Copy particle coordinates and orientations.
             for (unsigned int j=0;j<dimension;j++)
             {
@@ -208,6 +237,28 @@ namespace vmmc
         if (callbacks.boundaryCallback == nullptr) callbacks.isCustomBoundary = false;
         else callbacks.isCustomBoundary = true;
 
+        // Check for observer callback function.
+        if (callbacks.observerCallback == nullptr) callbacks.isObserver = false;
+        else callbacks.isObserver = true;
+
+        // Check for box callback function.
+        if (callbacks.boxCallback == nullptr) callbacks.isBoxUpdate = false;
+        else callbacks.isBoxUpdate = true;
+
+        // Check for bias callback function.
+        if (callbacks.biasCallback == nullptr) callbacks.isBias = false;
+        else callbacks.isBias = true;
+
+        // Check for many-body callback function.
+        if (callbacks.manyBodyCallback == nullptr) callbacks.isManyBody = false;
+        else callbacks.isManyBody = true;
+
+        // Check for neighbours callback function.
+        if (callbacks.neighboursCallback == nullptr) callbacks.isNeighbours = false;
+        else callbacks.isNeighbours = true;
+
+        nAffected = 0;
+
         std::cout << "Initialised VMMC";
 #ifdef ISOTROPIC
         std::cout << " (isotropic)";
@@ -241,6 +292,30 @@ namespace vmmc
 
     void VMMC::step()
     {
+        // No cluster rotation is in progress until one is proposed.
+        moveParams.isRotation = false;
+
+        // Volume move.
+        if ((probVolume > 0) && (rng() < probVolume))
+        {
+            stepVolume();
+            return;
+        }
+
+        // Aggregation-volume-bias move.
+        if ((probAVB > 0) && (rng() < probAVB))
+        {
+            stepAVB();
+            return;
+        }
+
+        // Identity swap move.
+        if ((probSwap > 0) && (rng() < probSwap))
+        {
+            stepSwap();
+            return;
+        }
+
         // Increment number of attempted moves.
         nAttempts++;
 
@@ -274,14 +349,30 @@ namespace vmmc
                 // Tally cluster size.
                 if (moveParams.isRotation) clusterRotations[nMoving-1]++;
                 else clusterTranslations[nMoving-1]++;
+
+                // Update periodic image counters.
+                for (unsigned int i=0;i<nMoving;i++)
+                {
+                    for (unsigned int j=0;j<dimension;j++)
+                        images[dimension*moveList[i] + j] += particles[moveList[i]].imageShift[j];
+                }
+
+                // Notify observer.
+                if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], true);
             }
             else
             {
                 // Undo move.
                 if (!isEarlyExit) swapMoveStatus();
+
+                // Notify observer.
+                if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], false);
             }
         }
 
+        // Notify observer of an aborted move (the cluster was never moved).
+        else if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], false);
+
         // Reset the move list.
         for (unsigned int i=0;i<nMoving;i++) particles[moveList[i]].isMoving = false;
 
@@ -294,6 +385,9 @@ namespace vmmc
             for (unsigned int i=0;i<nInteractions;i++)
                 pairEnergyMatrix[interactions[i][0]][interactions[i][1]] = 0;
         }
+
+        // Reset affected particles (in case of an early exit).
+        resetAffected();
     }
 
     unsigned long long VMMC::getAttempts() const
@@ -333,9 +427,206 @@ namespace vmmc
         return clusterRotations;
     }
 
+    void VMMC::getImages(int images_[]) const
+    {
+        for (unsigned int i=0;i<dimension*nParticles;i++)
+            images_[i] = images[i];
+    }
+
+    const std::vector<int>& VMMC::getImages() const
+    {
+        return images;
+    }
+
+    void VMMC::getUnwrappedCoordinates(double coordinates[]) const
+    {
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            for (unsigned int j=0;j<dimension;j++)
+                coordinates[dimension*i + j] = particles[i].preMovePosition[j] + images[dimension*i + j]*boxSize[j];
+        }
+    }
+
+    void VMMC::setAggregationVolumeBias(double probAVB_, double innerRadius, double outerRadius, double probBias)
+    {
+        // Check probabilities.
+        if ((probAVB_ < 0) || (probAVB_ > 1))
+        {
+            std::cerr << "[ERROR] VMMC: AVB move probability must be in range [0-1]!\n";
+            exit(EXIT_FAILURE);
+        }
+        if ((probBias <= 0) || (probBias >= 1))
+        {
+            std::cerr << "[ERROR] VMMC: AVB bias probability must be in range (0-1)!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // Check bonding volume.
+        if ((innerRadius < 0) || (outerRadius <= innerRadius))
+        {
+            std::cerr << "[ERROR] VMMC: AVB outer radius must be larger than inner radius!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        for (unsigned int i=0;i<dimension;i++)
+        {
+            if (2*outerRadius >= boxSize[i])
+            {
+                std::cerr << "[ERROR] VMMC: AVB outer radius must be less than half the box size!\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        probAVB = probAVB_;
+        probBiasAVB = probBias;
+        innerRadiusAVB = innerRadius;
+        outerRadiusAVB = outerRadius;
+
+        // Volume of the bonding region.
+        if (is3D) volumeInAVB = (4.0*M_PI/3.0)*(std::pow(outerRadius, 3) - std::pow(innerRadius, 3));
+        else volumeInAVB = M_PI*(outerRadius*outerRadius - innerRadius*innerRadius);
+
+        candidatesAVB.resize(nParticles);
+        neighboursAVB.resize(nParticles);
+        separationAVB.resize(dimension);
+    }
+
+    unsigned long long VMMC::getAggregationVolumeBiasAttempts() const
+    {
+        return nAttemptsAVB;
+    }
+
+    unsigned long long VMMC::getAggregationVolumeBiasAccepts() const
+    {
+        return nAcceptsAVB;
+    }
+
+    void VMMC::setVolumeMoves(double probVolume_, double pressure_, double maxLogVolumeChange_,
+        bool isPerAxis_, bool isClusterScaling_)
+    {
+        // Check probability.
+        if ((probVolume_ < 0) || (probVolume_ > 1))
+        {
+            std::cerr << "[ERROR] VMMC: Volume move probability must be in range [0-1]!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // Check pressure.
+        if (pressure_ < 0)
+        {
+            std::cerr << "[ERROR] VMMC: Pressure must be >= 0!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // Check maximum volume change.
+        if (maxLogVolumeChange_ <= 0)
+        {
+            std::cerr << "[ERROR] VMMC: Maximum volume change must be > 0!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // Check box callback.
+        if (!callbacks.isBoxUpdate)
+        {
+            std::cerr << "[ERROR] VMMC: Volume moves require a box callback!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        probVolume = probVolume_;
+        pressure = pressure_;
+        maxLogVolumeChange = maxLogVolumeChange_;
+        isPerAxis = isPerAxis_;
+        isClusterScaling = isClusterScaling_;
+
+        clusterLabels.resize(nParticles);
+        clusterCentres.resize(dimension*nParticles);
+    }
+
+    unsigned long long VMMC::getVolumeAttempts() const
+    {
+        return nAttemptsVolume;
+    }
+
+    unsigned long long VMMC::getVolumeAccepts() const
+    {
+        return nAcceptsVolume;
+    }
+
+    void VMMC::setSwapMoves(double probSwap_, const unsigned int* species_)
+    {
+        // Check probability.
+        if ((probSwap_ < 0) || (probSwap_ > 1))
+        {
+            std::cerr << "[ERROR] VMMC: Swap move probability must be in range [0-1]!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // Need at least two particles.
+        if ((probSwap_ > 0) && (nParticles < 2))
+        {
+            std::cerr << "[ERROR] VMMC: Swap moves require at least two particles!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        probSwap = probSwap_;
+
+        // Store particle species.
+        if (species_ == nullptr) species.clear();
+        else species.assign(species_, species_ + nParticles);
+    }
+
+    unsigned long long VMMC::getSwapAttempts() const
+    {
+        return nAttemptsSwap;
+    }
+
+    unsigned long long VMMC::getSwapAccepts() const
+    {
+        return nAcceptsSwap;
+    }
+
+    void VMMC::setEnergyQuantum(double quantum)
+    {
+        if (quantum < 0)
+        {
+            std::cerr << "[ERROR] VMMC: Energy quantum must be >= 0!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        isDiscrete = (quantum > 0);
+
+        energyQuantum = quantum;
+        inverseQuantum = isDiscrete ? 1.0/quantum : 0;
+
+        // Tabulate the Boltzmann factors of the first few levels, the table grows as needed.
+        maxLevel = 0;
+        boltzmannFactors.clear();
+        if (isDiscrete) computeBoltzmannFactor(16);
+    }
+
+    void VMMC::getBoxSize(double boxSize_[]) const
+    {
+        for (unsigned int i=0;i<dimension;i++)
+            boxSize_[i] = boxSize[i];
+    }
+
+    const std::vector<double>& VMMC::getBoxSize() const
+    {
+        return boxSize;
+    }
+
+    const double* VMMC::getRotationAxis() const
+    {
+        if (moveParams.isRotation && is3D) return &moveParams.trialVector[0];
+        else return nullptr;
+    }
+
     void VMMC::reset()
     {
         nAttempts = nAccepts = nRotations = 0;
+        nAttemptsAVB = nAcceptsAVB = 0;
+        nAttemptsVolume = nAcceptsVolume = 0;
+        nAttemptsSwap = nAcceptsSwap = 0;
         std::fill(clusterTranslations.begin(), clusterTranslations.end(), 0);
         std::fill(clusterRotations.begin(), clusterRotations.end(), 0);
     }
@@ -364,7 +655,7 @@ namespace vmmc
             moveParams.trialVector[i] /= norm;
 
         // Neighbour index (for isotropic rotations).
-        unsigned int neighbour;
+        unsigned int neighbour = 0;
 
         // Choose the move type.
         if (rng() < probTranslate)
@@ -466,6 +757,12 @@ namespace vmmc
         double energy;
         double excessEnergy = 0;
 
+        // Energy contributions that don't take discrete levels, e.g. many-body and bias.
+        double continuousEnergy = 0;
+
+        // Excess energy in multiples of the energy quantum.
+        int excessLevel = 0;
+
         // Construct pair interaction matrix (finite repulsions only).
         if (isRepusive)
         {
@@ -529,14 +826,19 @@ namespace vmmc
             for (unsigned int i=0;i<nMoving;i++)
             {
 #ifndef ISOTROPIC
-                excessEnergy -= callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0],
+                energy = callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0],
                     &particles[moveList[i]].preMoveOrientation[0]);
 #else
-                excessEnergy += callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0]);
+                energy = callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0]);
 #endif
+                excessEnergy -= energy;
+                if (isDiscrete) addLevel(energy, -1, excessLevel, continuousEnergy);
             }
         }
 
+        // Find the particles whose many-body energy is affected before the move.
+        if (callbacks.isManyBody) findAffected();
+
         // Apply the move.
         swapMoveStatus();
 
@@ -547,14 +849,17 @@ namespace vmmc
             if (callbacks.isNonPairwise)
             {
 #ifndef ISOTROPIC
-                excessEnergy += callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0],
+                energy = callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0],
                     &particles[moveList[i]].preMoveOrientation[0]);
 #else
-                excessEnergy += callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0]);
+                energy = callbacks.nonPairwiseCallback(moveList[i], &particles[moveList[i]].preMovePosition[0]);
 #endif
+                excessEnergy += energy;
 
                 // Early exit for large non-pairwise energies.
                 if (excessEnergy > 1e6) return false;
+
+                if (isDiscrete) addLevel(energy, 1, excessLevel, continuousEnergy);
             }
 
             if (!isRepusive)
@@ -611,7 +916,10 @@ namespace vmmc
                     {
                         // Check that particles didn't previously interact.
                         if (pairEnergyMatrix[x][y] == 0)
+                        {
                             excessEnergy += energy;
+                            if (isDiscrete) addLevel(energy, 1, excessLevel, continuousEnergy);
+                        }
                     }
                     else
                     {
@@ -625,7 +933,10 @@ namespace vmmc
 
                                 // Particles previously felt a repulsive interaction.
                                 if (pairEnergy > 0)
+                                {
                                     excessEnergy -= pairEnergy;
+                                    if (isDiscrete) addLevel(pairEnergy, -1, excessLevel, continuousEnergy);
+                                }
                             }
                         }
                     }
@@ -633,15 +944,760 @@ namespace vmmc
             }
         }
 
-        if (isRepusive || callbacks.isNonPairwise)
+        // Add the many-body energy change.
+        if (callbacks.isManyBody)
         {
-            if (rng() > exp(-excessEnergy)) return false;
+            findAffected();
+            energy = computeManyBody();
+            excessEnergy += energy;
+            continuousEnergy += energy;
+            if (excessEnergy > 1e6) return false;
+        }
+
+        // Add the bias potential.
+        if (callbacks.isBias)
+        {
+            energy = computeBias();
+            excessEnergy += energy;
+            continuousEnergy += energy;
+            if (excessEnergy > 1e6) return false;
+        }
+
+        if (isRepusive || callbacks.isNonPairwise || callbacks.isManyBody || callbacks.isBias)
+        {
+            double boltzmannFactor;
+
+            // Look up the Boltzmann factor of the discrete contributions.
+            if (isDiscrete)
+            {
+                boltzmannFactor = computeBoltzmannFactor(excessLevel);
+                if (continuousEnergy != 0) boltzmannFactor *= exp(-continuousEnergy);
+            }
+            else boltzmannFactor = exp(-excessEnergy);
+
+            if (rng() > boltzmannFactor) return false;
         }
 
         // Move successful.
         return true;
     }
 
+    void VMMC::stepAVB()
+    {
+        // Increment number of attempted AVB moves.
+        nAttemptsAVB++;
+
+        // Choose the target particle.
+        unsigned int target = rng.integer(0, nParticles-1);
+
+        // Whether the move is into the bonding volume of the target.
+        bool isMoveIn = (rng() < probBiasAVB);
+
+        // Index of the moving particle.
+        unsigned int particle;
+
+        // Number of particles in the bonding volume (in the configuration where the moving particle is inside).
+        unsigned int nBonding = 0;
+
+        // Find the particles within the bonding volume of the target, only
+        // testing those near the target if the model can find them.
+        if (callbacks.isNeighbours)
+        {
+            unsigned int nNeighbours = callbacks.neighboursCallback(target, outerRadiusAVB, &neighboursAVB[0]);
+
+            for (unsigned int i=0;i<nNeighbours;i++)
+            {
+                unsigned int neighbour = neighboursAVB[i];
+
+                if ((neighbour != target) && isBondingVolume(particles[neighbour].preMovePosition, target))
+                {
+                    candidatesAVB[nBonding] = neighbour;
+                    nBonding++;
+                }
+            }
+        }
+        else
+        {
+            for (unsigned int i=0;i<nParticles;i++)
+            {
+                if ((i != target) && isBondingVolume(particles[i].preMovePosition, target))
+                {
+                    candidatesAVB[nBonding] = i;
+                    nBonding++;
+                }
+            }
+        }
+
+        std::vector<double>& position = particles[target].preMovePosition;
+
+        if (isMoveIn)
+        {
+            // Choose a particle other than the target.
+            particle = rng.integer(0, nParticles-2);
+            if (particle >= target) particle++;
+
+            // Particle is already in the bonding volume.
+            if (isBondingVolume(particles[particle].preMovePosition, target))
+            {
+                if (callbacks.isObserver) callbacks.observerCallback(0, &moveList[0], false);
+                return;
+            }
+
+            // Account for the particle following the move.
+            nBonding++;
+
+            // Choose a point uniformly within the bonding volume.
+            double r;
+            if (is3D) r = std::pow(std::pow(innerRadiusAVB, 3)
+                + rng()*(std::pow(outerRadiusAVB, 3) - std::pow(innerRadiusAVB, 3)), 1.0/3.0);
+            else r = std::sqrt(innerRadiusAVB*innerRadiusAVB
+                + rng()*(outerRadiusAVB*outerRadiusAVB - innerRadiusAVB*innerRadiusAVB));
+
+            for (unsigned int i=0;i<dimension;i++)
+                moveParams.trialVector[i] = rng.normal();
+            double norm = computeNorm(moveParams.trialVector);
+
+            for (unsigned int i=0;i<dimension;i++)
+                particles[particle].postMovePosition[i] = position[i] + r*moveParams.trialVector[i]/norm;
+        }
+        else
+        {
+            // No particles to move out of the bonding volume.
+            if (nBonding == 0)
+            {
+                if (callbacks.isObserver) callbacks.observerCallback(0, &moveList[0], false);
+                return;
+            }
+
+            // Choose a particle from within the bonding volume.
+            particle = candidatesAVB[rng.integer(0, nBonding-1)];
+
+            // Choose a point uniformly outside of the bonding volume.
+            do
+            {
+                for (unsigned int i=0;i<dimension;i++)
+                    particles[particle].postMovePosition[i] = rng()*boxSize[i];
+            }
+            while (isBondingVolume(particles[particle].postMovePosition, target));
+        }
+
+        // Apply periodic boundary conditions (relocation doesn't alter the image counters).
+        applyPeriodicBoundaryConditions(particles[particle].postMovePosition, particles[particle].imageShift);
+        std::fill(particles[particle].imageShift.begin(), particles[particle].imageShift.end(), 0);
+
+#ifndef ISOTROPIC
+        particles[particle].postMoveOrientation = particles[particle].preMoveOrientation;
+
+        // Choose a random orientation for anisotropic particles.
+        if (!isIsotropic[particle])
+        {
+            for (unsigned int i=0;i<dimension;i++)
+                particles[particle].postMoveOrientation[i] = rng.normal();
+
+            double norm = computeNorm(particles[particle].postMoveOrientation);
+            for (unsigned int i=0;i<dimension;i++)
+                particles[particle].postMoveOrientation[i] /= norm;
+        }
+#endif
+
+        // Check custom boundary condition.
+        if (callbacks.isCustomBoundary)
+        {
+#ifndef ISOTROPIC
+            bool isOutsideBoundary = callbacks.boundaryCallback(particle,
+                &particles[particle].postMovePosition[0], &particles[particle].postMoveOrientation[0]);
+#else
+            bool isOutsideBoundary = callbacks.boundaryCallback(particle, &particles[particle].postMovePosition[0]);
+#endif
+            if (isOutsideBoundary)
+            {
+                if (callbacks.isObserver) callbacks.observerCallback(0, &moveList[0], false);
+                return;
+            }
+        }
+
+        // Volume outside of the bonding region (the box size may vary).
+        double volumeOut = -volumeInAVB;
+        double boxVolume = 1;
+        for (unsigned int i=0;i<dimension;i++) boxVolume *= boxSize[i];
+        volumeOut += boxVolume;
+
+        // Ratio of proposal probabilities for the reverse and forward moves.
+        double bias = ((1.0 - probBiasAVB)*(nParticles - 1)*volumeInAVB)/(probBiasAVB*nBonding*volumeOut);
+        if (!isMoveIn) bias = 1.0/bias;
+
+        // Pre-move energy.
+#ifndef ISOTROPIC
+        double energy = -callbacks.energyCallback(particle, &particles[particle].preMovePosition[0],
+            &particles[particle].preMoveOrientation[0]);
+        if (callbacks.isNonPairwise) energy -= callbacks.nonPairwiseCallback(particle,
+            &particles[particle].preMovePosition[0], &particles[particle].preMoveOrientation[0]);
+#else
+        double energy = -callbacks.energyCallback(particle, &particles[particle].preMovePosition[0]);
+        if (callbacks.isNonPairwise) energy -= callbacks.nonPairwiseCallback(particle,
+            &particles[particle].preMovePosition[0]);
+#endif
+
+        // Apply the move.
+        moveList[0] = particle;
+        nMoving = 1;
+        if (callbacks.isManyBody) findAffected();
+        swapMoveStatus();
+
+        // Post-move energy.
+#ifndef ISOTROPIC
+        energy += callbacks.energyCallback(particle, &particles[particle].preMovePosition[0],
+            &particles[particle].preMoveOrientation[0]);
+        if (callbacks.isNonPairwise) energy += callbacks.nonPairwiseCallback(particle,
+            &particles[particle].preMovePosition[0], &particles[particle].preMoveOrientation[0]);
+#else
+        energy += callbacks.energyCallback(particle, &particles[particle].preMovePosition[0]);
+        if (callbacks.isNonPairwise) energy += callbacks.nonPairwiseCallback(particle,
+            &particles[particle].preMovePosition[0]);
+#endif
+
+        // Add the many-body energy change.
+        if (callbacks.isManyBody)
+        {
+            findAffected();
+            energy += computeManyBody();
+        }
+
+        // Add the bias potential.
+        if (energy < 1e6) energy += computeBias();
+
+        // Metropolis test.
+        if ((energy < 1e6) && (rng() < bias*exp(-energy)))
+        {
+            nAcceptsAVB++;
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], true);
+        }
+        else
+        {
+            // Undo move.
+            swapMoveStatus();
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], false);
+        }
+    }
+
+    bool VMMC::isBondingVolume(std::vector<double>& position, unsigned int target)
+    {
+        // Calculate minimum image separation.
+        computeSeparation(particles[target].preMovePosition, position, separationAVB);
+
+        double normSqd = 0;
+        for (unsigned int i=0;i<dimension;i++)
+            normSqd += separationAVB[i]*separationAVB[i];
+
+        return ((normSqd >= innerRadiusAVB*innerRadiusAVB) && (normSqd < outerRadiusAVB*outerRadiusAVB));
+    }
+
+    void VMMC::stepVolume()
+    {
+        // Increment number of attempted volume moves.
+        nAttemptsVolume++;
+
+        // Random walk in the logarithm of the volume.
+        double logVolumeChange = maxLogVolumeChange*(2.0*rng() - 1.0);
+        double volumeRatio = exp(logVolumeChange);
+
+        // Work out the scale factor along each axis.
+        std::vector<double> scale(dimension);
+        if (isPerAxis)
+        {
+            std::fill(scale.begin(), scale.end(), 1.0);
+            scale[rng.integer(0, dimension-1)] = volumeRatio;
+        }
+        else std::fill(scale.begin(), scale.end(), exp(logVolumeChange/dimension));
+
+        double volume = 1;
+        for (unsigned int i=0;i<dimension;i++) volume *= boxSize[i];
+
+        // Number of independently scaled objects.
+        unsigned int nScaled = nParticles;
+
+        // Number of interactions before the move (cluster scaling only).
+        unsigned int nBonds = 0;
+
+        // Label clusters.
+        if (isClusterScaling) nScaled = computeClusters(nBonds);
+
+        // Pre-move energy.
+        double initialEnergy = computeTotalEnergy();
+
+        // Store the original box size and compute the new one.
+        std::vector<double> oldBoxSize = boxSize;
+        for (unsigned int i=0;i<dimension;i++)
+            boxSize[i] *= scale[i];
+
+        // Compute the rescaled coordinates.
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            Particle& particle = particles[i];
+
+            if (isClusterScaling)
+            {
+                for (unsigned int j=0;j<dimension;j++)
+                {
+                    // Translate the unwrapped cluster coordinates with the scaled cluster centre.
+                    double position = particle.clusterPosition[j]
+                        + (scale[j] - 1.0)*clusterCentres[dimension*clusterLabels[i] + j];
+
+                    // Wrap into the box (unwrapped coordinates can lie several images away).
+                    int shift = int(std::floor(position/boxSize[j]));
+                    particle.postMovePosition[j] = position - shift*boxSize[j];
+                    if (particle.postMovePosition[j] >= boxSize[j]) particle.postMovePosition[j] = 0;
+
+                    // Account for the periodic image of the unwrapped coordinates.
+                    particle.imageShift[j] = shift - int(std::floor(0.5 + (particle.clusterPosition[j]
+                        - particle.preMovePosition[j])/oldBoxSize[j]));
+                }
+            }
+            else
+            {
+                for (unsigned int j=0;j<dimension;j++)
+                    particle.postMovePosition[j] = particle.preMovePosition[j]*scale[j];
+
+                // Guard against rounding at the box boundary.
+                applyPeriodicBoundaryConditions(particle.postMovePosition, particle.imageShift);
+            }
+#ifndef ISOTROPIC
+            particle.postMoveOrientation = particle.preMoveOrientation;
+#endif
+
+            moveList[i] = i;
+        }
+        nMoving = nParticles;
+
+        // The AVB bonding volume must fit within half the new box.
+        bool isValidBox = true;
+        if (probAVB > 0)
+        {
+            for (unsigned int i=0;i<dimension;i++)
+            {
+                if (2*outerRadiusAVB >= boxSize[i]) isValidBox = false;
+            }
+        }
+
+        // Apply the new box (the model may also reject it, e.g. if it's too small for a cell list).
+        if (isValidBox) isValidBox = callbacks.boxCallback(&boxSize[0]);
+
+        // Reject the move, nothing has been applied.
+        if (!isValidBox)
+        {
+            boxSize = oldBoxSize;
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(0, &moveList[0], false);
+
+            return;
+        }
+
+        // Apply the move.
+        swapMoveStatus();
+
+        // Post-move energy.
+        double finalEnergy = computeTotalEnergy();
+
+        bool isAccepted = (finalEnergy < 1e6);
+
+        // Make sure that the cluster decomposition is unchanged.
+        if (isAccepted && isClusterScaling)
+        {
+            unsigned int pairInteractions[maxInteractions];
+            unsigned int nFinalBonds = 0;
+
+            for (unsigned int i=0;i<nParticles && isAccepted;i++)
+            {
+#ifndef ISOTROPIC
+                unsigned int nPairs = callbacks.interactionsCallback(i, &particles[i].preMovePosition[0],
+                    &particles[i].preMoveOrientation[0], pairInteractions);
+#else
+                unsigned int nPairs = callbacks.interactionsCallback(i, &particles[i].preMovePosition[0], pairInteractions);
+#endif
+                nFinalBonds += nPairs;
+
+                for (unsigned int j=0;j<nPairs;j++)
+                {
+                    if (clusterLabels[pairInteractions[j]] != clusterLabels[i])
+                    {
+                        isAccepted = false;
+                        break;
+                    }
+                }
+            }
+
+            if (nFinalBonds != nBonds) isAccepted = false;
+        }
+
+        // Metropolis test.
+        if (isAccepted)
+        {
+            double volumeChange = volume*(volumeRatio - 1.0);
+            double exponent = -(finalEnergy - initialEnergy) - pressure*volumeChange + (nScaled + 1)*logVolumeChange;
+
+            // Add the many-body energy change (all particles are affected).
+            if (callbacks.isManyBody)
+            {
+                for (unsigned int i=0;i<nParticles;i++)
+                {
+                    particles[i].isAffected = true;
+                    affectedList[i] = i;
+                }
+                nAffected = nParticles;
+
+                exponent -= computeManyBody();
+            }
+
+            // Add the bias potential.
+            exponent -= computeBias();
+
+            if (rng() >= exp(exponent)) isAccepted = false;
+        }
+
+        if (isAccepted)
+        {
+            nAcceptsVolume++;
+
+            // Update periodic image counters.
+            for (unsigned int i=0;i<nParticles;i++)
+            {
+                for (unsigned int j=0;j<dimension;j++)
+                    images[dimension*i + j] += particles[i].imageShift[j];
+            }
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], true);
+        }
+        else
+        {
+            // Undo move.
+            boxSize = oldBoxSize;
+            callbacks.boxCallback(&boxSize[0]);
+            swapMoveStatus();
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], false);
+        }
+    }
+
+    void VMMC::stepSwap()
+    {
+        // Increment number of attempted swap moves.
+        nAttemptsSwap++;
+
+        // Choose two distinct particles.
+        unsigned int particle1 = rng.integer(0, nParticles-1);
+        unsigned int particle2 = rng.integer(0, nParticles-2);
+        if (particle2 >= particle1) particle2++;
+
+        // Particles are indistinguishable.
+        if ((species.size() > 0) && (species[particle1] == species[particle2]))
+        {
+            if (callbacks.isObserver) callbacks.observerCallback(0, &moveList[0], false);
+            return;
+        }
+
+        // Exchange positions and orientations.
+        particles[particle1].postMovePosition = particles[particle2].preMovePosition;
+        particles[particle2].postMovePosition = particles[particle1].preMovePosition;
+#ifndef ISOTROPIC
+        particles[particle1].postMoveOrientation = particles[particle2].preMoveOrientation;
+        particles[particle2].postMoveOrientation = particles[particle1].preMoveOrientation;
+#endif
+
+        moveList[0] = particle1;
+        moveList[1] = particle2;
+        nMoving = 2;
+
+        // Check custom boundary condition.
+        if (callbacks.isCustomBoundary)
+        {
+            for (unsigned int i=0;i<nMoving;i++)
+            {
+#ifndef ISOTROPIC
+                bool isOutsideBoundary = callbacks.boundaryCallback(moveList[i],
+                    &particles[moveList[i]].postMovePosition[0], &particles[moveList[i]].postMoveOrientation[0]);
+#else
+                bool isOutsideBoundary = callbacks.boundaryCallback(moveList[i],
+                    &particles[moveList[i]].postMovePosition[0]);
+#endif
+                if (isOutsideBoundary)
+                {
+                    if (callbacks.isObserver) callbacks.observerCallback(0, &moveList[0], false);
+                    return;
+                }
+            }
+        }
+
+        // Energy change. The pair energy between the two particles is
+        // counted by both particle energies so must be subtracted once.
+        double energy = 0;
+
+        for (int direction=-1;direction<=1;direction+=2)
+        {
+            // Apply the move.
+            if (direction == 1) swapMoveStatus();
+
+            // Find the particles whose many-body energy is affected.
+            if (callbacks.isManyBody) findAffected();
+
+            for (unsigned int i=0;i<nMoving;i++)
+            {
+#ifndef ISOTROPIC
+                double particleEnergy = callbacks.energyCallback(moveList[i],
+                    &particles[moveList[i]].preMovePosition[0], &particles[moveList[i]].preMoveOrientation[0]);
+                if (callbacks.isNonPairwise) particleEnergy += callbacks.nonPairwiseCallback(moveList[i],
+                    &particles[moveList[i]].preMovePosition[0], &particles[moveList[i]].preMoveOrientation[0]);
+#else
+                double particleEnergy = callbacks.energyCallback(moveList[i], &particles[moveList[i]].preMovePosition[0]);
+                if (callbacks.isNonPairwise) particleEnergy += callbacks.nonPairwiseCallback(moveList[i],
+                    &particles[moveList[i]].preMovePosition[0]);
+#endif
+                // Overlap.
+                if (particleEnergy > 1e6)
+                {
+                    energy = INFINITY;
+                    break;
+                }
+
+                energy += direction*particleEnergy;
+            }
+
+#ifndef ISOTROPIC
+            double pairEnergy = callbacks.pairEnergyCallback(particle1, &particles[particle1].preMovePosition[0],
+                &particles[particle1].preMoveOrientation[0], particle2, &particles[particle2].preMovePosition[0],
+                &particles[particle2].preMoveOrientation[0]);
+#else
+            double pairEnergy = callbacks.pairEnergyCallback(particle1, &particles[particle1].preMovePosition[0],
+                particle2, &particles[particle2].preMovePosition[0]);
+#endif
+            if (pairEnergy < 1e6) energy -= direction*pairEnergy;
+        }
+
+        // Add the many-body energy change.
+        if (callbacks.isManyBody) energy += computeManyBody();
+
+        // Add the bias potential.
+        if (energy < 1e6) energy += computeBias();
+
+        // Metropolis test.
+        if ((energy < 1e6) && (rng() < exp(-energy)))
+        {
+            nAcceptsSwap++;
+
+            // Exchange periodic image counters.
+            for (unsigned int i=0;i<dimension;i++)
+                std::swap(images[dimension*particle1 + i], images[dimension*particle2 + i]);
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], true);
+        }
+        else
+        {
+            // Undo move.
+            swapMoveStatus();
+
+            // Notify observer.
+            if (callbacks.isObserver) callbacks.observerCallback(nMoving, &moveList[0], false);
+        }
+    }
+
+    bool VMMC::computeLevel(double energy, int& level) const
+    {
+        // Overlaps (and energies too large to be a level).
+        if (std::abs(energy) > 1e6) return false;
+
+        double quanta = energy*inverseQuantum;
+        level = int(std::lround(quanta));
+
+        return (std::abs(quanta - level) < 1e-6);
+    }
+
+    void VMMC::addLevel(double energy, int sign, int& excessLevel, double& continuousEnergy) const
+    {
+        int level;
+
+        if (computeLevel(energy, level)) excessLevel += sign*level;
+        else continuousEnergy += sign*energy;
+    }
+
+    double VMMC::computeBoltzmannFactor(int level)
+    {
+        // Levels beyond the cap are rare, so aren't worth tabulating.
+        if (std::abs(level) > MAX_LEVEL) return exp(-level*energyQuantum);
+
+        // Extend the table, at least doubling its range.
+        if (std::abs(level) > maxLevel)
+        {
+            maxLevel = std::min(std::max(std::abs(level), 2*maxLevel), MAX_LEVEL);
+
+            boltzmannFactors.resize(2*maxLevel + 1);
+            for (int i=-maxLevel;i<=maxLevel;i++)
+                boltzmannFactors[i + maxLevel] = exp(-i*energyQuantum);
+        }
+
+        return boltzmannFactors[level + maxLevel];
+    }
+
+    double VMMC::computeBias()
+    {
+        if (callbacks.isBias) return callbacks.biasCallback(nMoving, &moveList[0]);
+        else return 0;
+    }
+
+    void VMMC::findAffected()
+    {
+        unsigned int pairInteractions[maxInteractions];
+
+        for (unsigned int i=0;i<nMoving;i++)
+        {
+            unsigned int particle = moveList[i];
+
+            // Add the moving particle.
+            if (!particles[particle].isAffected)
+            {
+                particles[particle].isAffected = true;
+                affectedList[nAffected] = particle;
+                nAffected++;
+            }
+
+            // Add the particles that it interacts with.
+#ifndef ISOTROPIC
+            unsigned int nPairs = callbacks.interactionsCallback(particle, &particles[particle].preMovePosition[0],
+                &particles[particle].preMoveOrientation[0], pairInteractions);
+#else
+            unsigned int nPairs = callbacks.interactionsCallback(particle,
+                &particles[particle].preMovePosition[0], pairInteractions);
+#endif
+
+            for (unsigned int j=0;j<nPairs;j++)
+            {
+                if (!particles[pairInteractions[j]].isAffected)
+                {
+                    particles[pairInteractions[j]].isAffected = true;
+                    affectedList[nAffected] = pairInteractions[j];
+                    nAffected++;
+                }
+            }
+        }
+    }
+
+    double VMMC::computeManyBody()
+    {
+        double energy = 0;
+
+        if (callbacks.isManyBody) energy = callbacks.manyBodyCallback(nAffected, &affectedList[0]);
+        resetAffected();
+
+        return energy;
+    }
+
+    void VMMC::resetAffected()
+    {
+        for (unsigned int i=0;i<nAffected;i++) particles[affectedList[i]].isAffected = false;
+        nAffected = 0;
+    }
+
+    double VMMC::computeTotalEnergy()
+    {
+        double energy = 0;
+        double excessEnergy = 0;
+
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+#ifndef ISOTROPIC
+            double particleEnergy = callbacks.energyCallback(i, &particles[i].preMovePosition[0],
+                &particles[i].preMoveOrientation[0]);
+            if (callbacks.isNonPairwise) excessEnergy += callbacks.nonPairwiseCallback(i,
+                &particles[i].preMovePosition[0], &particles[i].preMoveOrientation[0]);
+#else
+            double particleEnergy = callbacks.energyCallback(i, &particles[i].preMovePosition[0]);
+            if (callbacks.isNonPairwise) excessEnergy += callbacks.nonPairwiseCallback(i,
+                &particles[i].preMovePosition[0]);
+#endif
+
+            // Overlap.
+            if (particleEnergy > 1e6) return INFINITY;
+
+            energy += particleEnergy;
+        }
+
+        // Pair energies are counted twice.
+        return 0.5*energy + excessEnergy;
+    }
+
+    unsigned int VMMC::computeClusters(unsigned int& nBonds)
+    {
+        unsigned int nClusters = 0;
+        unsigned int pairInteractions[maxInteractions];
+        std::vector<double> delta(dimension);
+
+        nBonds = 0;
+
+        // Unassigned particles are labelled with nParticles.
+        std::fill(clusterLabels.begin(), clusterLabels.end(), nParticles);
+
+        for (unsigned int i=0;i<nParticles;i++)
+        {
+            if (clusterLabels[i] != nParticles) continue;
+
+            // Seed a new cluster.
+            unsigned int head = 0;
+            unsigned int size = 1;
+            moveList[0] = i;
+            clusterLabels[i] = nClusters;
+            particles[i].clusterPosition = particles[i].preMovePosition;
+
+            // Breadth-first search, storing unwrapped coordinates relative to the seed.
+            while (head < size)
+            {
+                unsigned int particle = moveList[head++];
+
+#ifndef ISOTROPIC
+                unsigned int nPairs = callbacks.interactionsCallback(particle, &particles[particle].preMovePosition[0],
+                    &particles[particle].preMoveOrientation[0], pairInteractions);
+#else
+                unsigned int nPairs = callbacks.interactionsCallback(particle,
+                    &particles[particle].preMovePosition[0], pairInteractions);
+#endif
+                nBonds += nPairs;
+
+                for (unsigned int j=0;j<nPairs;j++)
+                {
+                    unsigned int neighbour = pairInteractions[j];
+
+                    if (clusterLabels[neighbour] == nParticles)
+                    {
+                        clusterLabels[neighbour] = nClusters;
+                        computeSeparation(particles[particle].clusterPosition, particles[neighbour].preMovePosition, delta);
+                        for (unsigned int k=0;k<dimension;k++)
+                            particles[neighbour].clusterPosition[k] = particles[particle].clusterPosition[k] + delta[k];
+                        moveList[size++] = neighbour;
+                    }
+                }
+            }
+
+            // Compute the centre of the unwrapped cluster.
+            for (unsigned int k=0;k<dimension;k++)
+            {
+                double centre = 0;
+                for (unsigned int j=0;j<size;j++)
+                    centre += particles[moveList[j]].clusterPosition[k];
+
+                clusterCentres[dimension*nClusters + k] = centre/size;
+            }
+
+            nClusters++;
+        }
+
+        return nClusters;
+    }
+
     double VMMC::computeHydrodynamicRadius() const
     {
         std::vector<double> centerOfMass(dimension);
@@ -758,7 +1814,7 @@ namespace vmmc
         }
 
         // Apply periodic boundary conditions.
-        applyPeriodicBoundaryConditions(postMoveParticle.postMovePosition);
+        applyPeriodicBoundaryConditions(postMoveParticle.postMovePosition, postMoveParticle.imageShift);
     }
 
     void VMMC::initiateParticle(unsigned int particle, Particle& linker)
@@ -853,11 +1909,27 @@ namespace vmmc
                             neighbour, &particles[neighbour].preMovePosition[0]);
 #endif
 
-                        // Forward link weight.
-                        double linkWeight = std::max(1.0-exp(initialEnergy-finalEnergy),0.0);
+                        double linkWeight, reverseLinkWeight;
 
-                        // Reverse link weight.
-                        double reverseLinkWeight = std::max(1.0-exp(initialEnergy-reverseMoveEnergy),0.0);
+                        int initialLevel, finalLevel, reverseMoveLevel;
+
+                        if (isDiscrete && computeLevel(initialEnergy, initialLevel)
+                            && computeLevel(finalEnergy, finalLevel) && computeLevel(reverseMoveEnergy, reverseMoveLevel))
+                        {
+                            // Look up the link weights from the change in level, 1 - exp(initialEnergy - finalEnergy).
+                            linkWeight = (finalLevel > initialLevel) ?
+                                1.0 - computeBoltzmannFactor(finalLevel - initialLevel) : 0;
+                            reverseLinkWeight = (reverseMoveLevel > initialLevel) ?
+                                1.0 - computeBoltzmannFactor(reverseMoveLevel - initialLevel) : 0;
+                        }
+                        else
+                        {
+                            // Forward link weight.
+                            linkWeight = std::max(1.0-exp(initialEnergy-finalEnergy),0.0);
+
+                            // Reverse link weight.
+                            reverseLinkWeight = std::max(1.0-exp(initialEnergy-reverseMoveEnergy),0.0);
+                        }
 
                         // Test links.
                         if (rng() <= linkWeight)
@@ -949,19 +2021,23 @@ namespace vmmc
         }
     }
 
-    void VMMC::applyPeriodicBoundaryConditions(std::vector<double>& vec)
+    void VMMC::applyPeriodicBoundaryConditions(std::vector<double>& vec, std::vector<int>& imageShift)
     {
         for (unsigned int i=0;i<vec.size();i++)
         {
+            imageShift[i] = 0;
+
             if (vec[i] < 0)
             {
                 vec[i] += boxSize[i];
+                imageShift[i] = -1;
             }
             else
             {
                 if (vec[i] >= boxSize[i])
                 {
                     vec[i] -= boxSize[i];
+                    imageShift[i] = 1;
                 }
             }
         }
@@ -162,6 +162,109 @@ namespace vmmc
     typedef std::function<bool (unsigned int, const double*)> BoundaryCallback;
 #endif
 
+    //! Observe the outcome of a trial move.
+    /*! The observer is called once for every trial move. For a move that
+        was applied to the system, it is called after the post-move callback
+        has been triggered for each particle in the moving cluster. If the
+        move was rejected then the particles will already have been returned
+        to their original state. Moves that are aborted before being applied,
+        e.g. when the cluster size cut-off is exceeded, are reported as
+        rejected, so observers that sample the current state, such as
+        Wang-Landau schemes, see every trial.
+
+        \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \param isAccepted
+            Whether the move was accepted.
+    */
+    typedef std::function<void (unsigned int, const unsigned int*, bool)> ObserverCallback;
+
+    //! Update the size of the simulation box.
+    /*! The box callback is triggered during a volume move, before the
+        post-move callback is called for each particle with its rescaled
+        position. If the model can't accommodate the new box, e.g. it is too
+        small for a cell list, the callback should leave the model unchanged
+        and return false, in which case the volume move is rejected.
+
+        \param boxSize
+            The new size of the simulation box in each dimension.
+
+        \return
+            Whether the box size was updated.
+    */
+    typedef std::function<bool (const double*)> BoxCallback;
+
+    //! Calculate the change in a bias potential following a trial move.
+    /*! The bias callback is triggered once a trial move has been applied,
+        i.e. the post-move callback has been called for each moving particle,
+        and immediately before the final acceptance test. The returned bias is
+        added to the energy change of the move. Whenever the bias callback is
+        triggered, the observer callback is subsequently triggered with the
+        outcome of the move, so any trial state held by the bias can be
+        committed or discarded.
+
+        \param nMoving
+            The number of particles in the moving cluster.
+
+        \param moveList
+            The indices of the particles in the moving cluster.
+
+        \return
+            The change in the bias potential (in units of kBT).
+    */
+    typedef std::function<double (unsigned int, const unsigned int*)> BiasCallback;
+
+    //! Calculate the change in a local many-body energy following a trial move.
+    /*! The many-body callback is for energies that are a sum of local terms,
+        one per particle, where each term depends on the environment of the
+        particle, e.g. its coordination number. It is triggered once a trial
+        move has been applied, i.e. the post-move callback has been called for
+        each moving particle. The affected particles are those in the moving
+        cluster, plus all particles that they interact with, either before or
+        after the move, as reported by the interactions callback. Only the
+        local terms of the affected particles can change, so only these need
+        to be recomputed. The returned change is added to the energy change of
+        the move. As with the bias callback, the observer callback is
+        subsequently triggered with the outcome of the move, so the recomputed
+        terms can be committed or discarded.
+
+        \param nAffected
+            The number of affected particles.
+
+        \param affected
+            The indices of the affected particles.
+
+        \return
+            The change in the many-body energy (in units of kBT).
+    */
+    typedef std::function<double (unsigned int, const unsigned int*)> ManyBodyCallback;
+
+    //! Find the particles close to a given particle.
+    /*! The neighbours callback is optional. When defined, it is used by AVB
+        moves to find the particles in the bonding volume of the target
+        particle, e.g. using a cell list, rather than testing every particle
+        in the system. Every particle within the given distance of the
+        particle must be reported. Others may also be included, since the
+        candidates are subsequently filtered by distance.
+
+        \param particle
+            The particle index.
+
+        \param distance
+            The search distance.
+
+        \param neighbours
+            An array to store the indices of the neighbouring particles (with room for every particle).
+
+        \return
+            The number of neighbours.
+    */
+    typedef std::function<unsigned int (unsigned int, double, unsigned int[])> NeighboursCallback;
+
     // DATA TYPES
 
     //! Container for storing virtual move parameters.
@@ -189,10 +292,12 @@ namespace vmmc
         unsigned int index;                         //!< Particle index.
         bool isMoving;                              //!< Whether the particle is part of the virtual move.
         bool isFrustrated;                          //!< Whether the particle is involved in a frustrated link.
+        bool isAffected;                            //!< Whether the particle's many-body energy is affected by the move.
         unsigned int posFrustated;                  //!< Index in the frustrated links array.
         std::vector<double> preMovePosition;        //!< Particle position before the virtual move.
         std::vector<double> postMovePosition;       //!< Particle position following the virtual move.
         std::vector<double> clusterPosition;        //!< Position of the particle in the moving cluster (relative to seed).
+        std::vector<int> imageShift;                //!< Periodic image crossings during the virtual move.
 #ifndef ISOTROPIC
         std::vector<double> preMoveOrientation;     //!< Particle orientation before the virtual move.
         std::vector<double> postMoveOrientation;    //!< Particle orientation following the virtual move.
@@ -208,9 +313,19 @@ namespace vmmc
         PostMoveCallback postMoveCallback;          //!< Callback function to apply any post-move updates.
         NonPairwiseCallback nonPairwiseCallback;    //!< Callback function to calculate non-pairwise interaction energies.
         BoundaryCallback boundaryCallback;          //!< Callback function to apply custom boundary conditions.
+        ObserverCallback observerCallback;          //!< Callback function to observe completed trial moves.
+        BoxCallback boxCallback;                    //!< Callback function to update the simulation box size.
+        BiasCallback biasCallback;                  //!< Callback function to calculate bias potential changes.
+        ManyBodyCallback manyBodyCallback;          //!< Callback function to calculate many-body energy changes.
+        NeighboursCallback neighboursCallback;      //!< Callback function to find nearby particles.
 
         bool isNonPairwise;                         //!< Whether the non-pairwise energy callback is defined.
         bool isCustomBoundary;                      //!< Whether the boundary callback is defined.
+        bool isObserver;                            //!< Whether the observer callback is defined.
+        bool isBoxUpdate;                           //!< Whether the box callback is defined.
+        bool isBias;                                //!< Whether the bias callback is defined.
+        bool isManyBody;                            //!< Whether the many-body callback is defined.
+        bool isNeighbours;                          //!< Whether the neighbours callback is defined.
     };
 
     //! Main VMMC class.
@@ -321,12 +436,176 @@ namespace vmmc
         */
         const std::vector<unsigned long long>& getClusterRotations() const;
 
+        //! Get the periodic image counters for all particles.
+        /*! \param images
+                An array into which the image counters will be copied,
+                i.e. ix1, iy1, iz1, ix2, iy2, iz2, ... , ixN, iyN, izN.
+        */
+        void getImages(int[]) const;
+
+        //! Get the periodic image counters for all particles.
+        /*! \return
+                A const reference to the image counter vector.
+        */
+        const std::vector<int>& getImages() const;
+
+        //! Get the unwrapped coordinates of all particles.
+        /*! \param coordinates
+                An array into which the unwrapped coordinates will be copied.
+        */
+        void getUnwrappedCoordinates(double[]) const;
+
+        //! Enable aggregation-volume-bias (AVB) moves.
+        /*! AVB moves relocate a single particle directly into or out of the
+            bonding volume of a randomly chosen target particle, following
+            Chen and Siepmann, J. Phys. Chem. B 104, 8725 (2000). The bonding
+            volume is the spherical (circular) shell between the inner and
+            outer radius around the target. Anisotropic particles are given
+            a random orientation. Note that AVB moves are non-local and do not
+            approximate the dynamics of the system. If a neighbours callback
+            is defined, the occupants of the bonding volume are found among
+            the neighbours of the target, otherwise every particle is tested.
+
+            \param probAVB_
+                The probability that a trial move is an AVB move (zero disables AVB moves).
+
+            \param innerRadius
+                The inner radius of the bonding volume.
+
+            \param outerRadius
+                The outer radius of the bonding volume.
+
+            \param probBias
+                The probability of attempting a move into (versus out of) the bonding volume.
+        */
+        void setAggregationVolumeBias(double, double, double, double probBias = 0.5);
+
+        //! Get the number of attempted AVB moves.
+        /*! \return
+                The number of attempted AVB moves.
+        */
+        unsigned long long getAggregationVolumeBiasAttempts() const;
+
+        //! Get the number of accepted AVB moves.
+        /*! \return
+                The number of accepted AVB moves.
+        */
+        unsigned long long getAggregationVolumeBiasAccepts() const;
+
+        //! Enable isobaric volume moves.
+        /*! Volume moves perform a random walk in the logarithm of the box
+            volume at constant pressure. Either all box dimensions are scaled
+            equally, or a single randomly chosen axis is scaled. Particle
+            coordinates are rescaled affinely or, if cluster scaling is
+            enabled, clusters of interacting particles are translated rigidly
+            with their scaled centres. Cluster moves that change the cluster
+            decomposition are rejected. The box callback must be defined.
+
+            \param probVolume_
+                The probability that a trial move is a volume move (zero disables volume moves).
+
+            \param pressure_
+                The pressure (in units of kBT per unit volume).
+
+            \param maxLogVolumeChange_
+                The maximum change in the logarithm of the box volume.
+
+            \param isPerAxis_
+                Whether to scale a single axis at a time (versus isotropic scaling).
+
+            \param isClusterScaling_
+                Whether to rescale clusters rigidly.
+        */
+        void setVolumeMoves(double, double, double, bool isPerAxis_ = false, bool isClusterScaling_ = false);
+
+        //! Get the number of attempted volume moves.
+        /*! \return
+                The number of attempted volume moves.
+        */
+        unsigned long long getVolumeAttempts() const;
+
+        //! Get the number of accepted volume moves.
+        /*! \return
+                The number of accepted volume moves.
+        */
+        unsigned long long getVolumeAccepts() const;
+
+        //! Enable identity swap moves.
+        /*! A swap move exchanges the positions and orientations of two
+            randomly chosen particles, which is equivalent to exchanging
+            their identities, e.g. diameters in a polydisperse system or
+            species in a mixture. Swaps between particles of the same species
+            are rejected outright.
+
+            \param probSwap_
+                The probability that a trial move is a swap move (zero disables swap moves).
+
+            \param species
+                The species of each particle (optional). If omitted, all
+                particles are assumed to be distinct.
+        */
+        void setSwapMoves(double, const unsigned int* species = nullptr);
+
+        //! Get the number of attempted swap moves.
+        /*! \return
+                The number of attempted swap moves.
+        */
+        unsigned long long getSwapAttempts() const;
+
+        //! Get the number of accepted swap moves.
+        /*! \return
+                The number of accepted swap moves.
+        */
+        unsigned long long getSwapAccepts() const;
+
+        //! Declare that the model energies are multiples of an energy quantum.
+        /*! For models whose pair (and non-pairwise) energies only take
+            discrete values, e.g. square-well potentials, each energy is
+            rounded to an integer level, i.e. a multiple of the quantum, and
+            the link weights and Boltzmann factors are looked up from a table
+            indexed by level, so no exponentials are evaluated when building
+            clusters or testing for acceptance. The table is extended as new
+            levels are encountered, e.g. the doubly bonded pairs of a patchy
+            model. Energies that aren't a multiple of the quantum, and
+            overlaps, are handled exactly, as if the discrete mode were
+            disabled.
+
+            \param quantum
+                The energy quantum (in units of kBT, zero disables the discrete mode).
+        */
+        void setEnergyQuantum(double);
+
+        //! Get the size of the simulation box.
+        /*! \param boxSize
+                An array into which the box size will be copied.
+        */
+        void getBoxSize(double[]) const;
+
+        //! Get the size of the simulation box.
+        /*! \return
+                A const reference to the box size vector.
+        */
+        const std::vector<double>& getBoxSize() const;
+
+        //! Get the rotation axis of the current trial move.
+        /*! Callbacks can use this to carry body-frame state rigidly with a
+            cluster rotation, e.g. spin about the orientation vector.
+
+            \return
+                A pointer to the unit axis, or nullptr if the current move
+                isn't a three dimensional cluster rotation.
+        */
+        const double* getRotationAxis() const;
+
         //! Reset statistics.
         void reset();
 
         MersenneTwister rng;                        //!< Random number generator.
 
     private:
+        //! The largest level (in magnitude) in the Boltzmann factor table.
+        static const int MAX_LEVEL = 1024;
+
         Parameters moveParams;                      //!< Parameters for the trial move.
         unsigned long long nAttempts;               //!< Number of attempted moves.
         unsigned long long nAccepts;                //!< Number of accepted moves.
@@ -349,6 +628,7 @@ namespace vmmc
         CallbackFunctions callbacks;                //!< Callback functions.
 
         std::vector<Particle> particles;            //!< Vector of particles.
+        std::vector<int> images;                    //!< Number of periodic boundary crossings for each particle.
 
         unsigned int nMoving;                                   //!< The number of particles in the cluster.
         std::vector<unsigned int> moveList;                     //!< the indices of particles in the cluster.
@@ -362,15 +642,141 @@ namespace vmmc
         std::vector<std::vector<unsigned int> > interactions;   //!< Indices of particle pairs that interact in the cluster.
         std::vector<std::vector<double> > pairEnergyMatrix;     //!< Pair energies for particle interactions in the cluster.
 
+        unsigned int nAffected;                                 //!< The number of particles with affected many-body energies.
+        std::vector<unsigned int> affectedList;                 //!< The indices of particles with affected many-body energies.
+
         unsigned int cutOff;                        //!< The cut-off cluster size for the trial move.
         bool isEarlyExit;                           //!< Whether trial move aborted early.
 
+        double probAVB;                             //!< The probability of an AVB move.
+        double probBiasAVB;                         //!< The probability of an AVB move into the bonding volume.
+        double innerRadiusAVB;                      //!< Inner radius of the AVB bonding volume.
+        double outerRadiusAVB;                      //!< Outer radius of the AVB bonding volume.
+        double volumeInAVB;                         //!< Volume of the AVB bonding region.
+        unsigned long long nAttemptsAVB;            //!< Number of attempted AVB moves.
+        unsigned long long nAcceptsAVB;             //!< Number of accepted AVB moves.
+        std::vector<unsigned int> candidatesAVB;    //!< Particles in the bonding volume of the AVB target.
+        std::vector<unsigned int> neighboursAVB;    //!< Particles near the AVB target.
+        std::vector<double> separationAVB;          //!< Separation workspace for the bonding volume test.
+
+        double probVolume;                          //!< The probability of a volume move.
+        double pressure;                            //!< The pressure.
+        double maxLogVolumeChange;                  //!< The maximum change in the logarithm of the volume.
+        bool isPerAxis;                             //!< Whether volume moves scale a single axis.
+        bool isClusterScaling;                      //!< Whether volume moves rescale clusters rigidly.
+        unsigned long long nAttemptsVolume;         //!< Number of attempted volume moves.
+        unsigned long long nAcceptsVolume;          //!< Number of accepted volume moves.
+        std::vector<unsigned int> clusterLabels;    //!< Cluster label of each particle (cluster scaling).
+        std::vector<double> clusterCentres;         //!< Centre of each cluster (cluster scaling).
+
+        double probSwap;                            //!< The probability of a swap move.
+        std::vector<unsigned int> species;          //!< The species of each particle (swap moves).
+        unsigned long long nAttemptsSwap;           //!< Number of attempted swap moves.
+        unsigned long long nAcceptsSwap;            //!< Number of accepted swap moves.
+
+        bool isDiscrete;                            //!< Whether the model energies take discrete levels.
+        double energyQuantum;                       //!< The energy quantum.
+        double inverseQuantum;                      //!< The reciprocal of the energy quantum.
+        int maxLevel;                               //!< The largest level (in magnitude) in the Boltzmann factor table.
+        std::vector<double> boltzmannFactors;       //!< Boltzmann factor of each level (offset by maxLevel).
+
         //! Propose a trial particle translation/rotation.
         void proposeMove();
 
         //! Determine whether move is accepted.
         bool accept();
 
+        //! Perform an aggregation-volume-bias trial move.
+        void stepAVB();
+
+        //! Check whether a position lies in the bonding volume of a particle.
+        /*! \param position
+                The position vector.
+
+            \param target
+                Index of the target particle.
+
+            \return
+                Whether the position lies within the bonding volume.
+        */
+        bool isBondingVolume(std::vector<double>&, unsigned int);
+
+        //! Perform a volume trial move.
+        void stepVolume();
+
+        //! Perform an identity swap trial move.
+        void stepSwap();
+
+        //! Map an energy to its discrete level.
+        /*! \param energy
+                The energy.
+
+            \param level
+                The level, i.e. the nearest multiple of the energy quantum.
+
+            \return
+                Whether the energy is a multiple of the energy quantum.
+        */
+        bool computeLevel(double, int&) const;
+
+        //! Add an energy to the discrete (or continuous) excess energy of a move.
+        /*! \param energy
+                The energy.
+
+            \param sign
+                Whether the energy is added (+1) or subtracted (-1).
+
+            \param excessLevel
+                The excess energy of the move, in multiples of the energy quantum.
+
+            \param continuousEnergy
+                The excess energy of the move that isn't a multiple of the energy quantum.
+        */
+        void addLevel(double, int, int&, double&) const;
+
+        //! Look up the Boltzmann factor of a level, extending the table if necessary.
+        //! Levels larger in magnitude than MAX_LEVEL are computed directly.
+        /*! \param level
+                The level.
+
+            \return
+                The Boltzmann factor.
+        */
+        double computeBoltzmannFactor(int);
+
+        //! Compute the change in the bias potential for the current trial move.
+        /*! \return
+                The change in the bias potential (zero if no bias is defined).
+        */
+        double computeBias();
+
+        //! Add the moving particles and their interaction partners to the affected list.
+        void findAffected();
+
+        //! Compute the change in the many-body energy for the current trial move.
+        /*! \return
+                The change in the many-body energy (zero if no many-body callback is defined).
+        */
+        double computeManyBody();
+
+        //! Clear the list of affected particles.
+        void resetAffected();
+
+        //! Compute the total energy of the system.
+        /*! \return
+                The total energy (infinite if there are overlaps).
+        */
+        double computeTotalEnergy();
+
+        //! Label clusters of interacting particles and compute their centres.
+        /*! \param nBonds
+                The total number of interactions (counted for each particle).
+
+            \return
+                The number of clusters.
+        */
+        unsigned int computeClusters(unsigned int&);
+
         //! Compute the hydrodynamic radius of the moving cluster.
         double computeHydrodynamicRadius() const;
 
@@ -446,8 +852,11 @@ namespace vmmc
         //! Enforce periodic boundary conditions.
         /*! \param vec
                 The coordinate vector.
+
+            \param imageShift
+                The change in periodic image in each dimension.
         */
-        void applyPeriodicBoundaryConditions(std::vector<double>&);
+        void applyPeriodicBoundaryConditions(std::vector<double>&, std::vector<int>&);
 
         //! Compute the norm of a vector.
         /*! \param vec